@@ -0,0 +1,188 @@
+#include <QtTest>
+#include <stdexcept>
+
+#include "benchdata.h"
+#include "taskcontainers.h"
+
+namespace {
+
+// The node-per-element containers RingQueue and Stack replaced, kept
+// here as the baseline.
+struct TaskNode {
+    Task data;
+    TaskNode *next;
+};
+
+class LinkedTaskQueue {
+public:
+    LinkedTaskQueue() : m_front(nullptr), m_rear(nullptr) {}
+    ~LinkedTaskQueue()
+    {
+        while (!isEmpty())
+            dequeue();
+    }
+
+    bool isEmpty() const { return m_front == nullptr; }
+
+    void enqueue(const Task &task)
+    {
+        TaskNode *node = new TaskNode{task, nullptr};
+        if (m_rear)
+            m_rear->next = node;
+        else
+            m_front = node;
+        m_rear = node;
+    }
+
+    Task dequeue()
+    {
+        if (isEmpty())
+            throw std::runtime_error("Queue is empty");
+        TaskNode *node = m_front;
+        Task task = node->data;
+        m_front = node->next;
+        if (!m_front)
+            m_rear = nullptr;
+        delete node;
+        return task;
+    }
+
+private:
+    TaskNode *m_front;
+    TaskNode *m_rear;
+};
+
+struct StackNode {
+    TaskAction data;
+    StackNode *next;
+};
+
+class LinkedStack {
+public:
+    LinkedStack() : m_top(nullptr) {}
+    ~LinkedStack()
+    {
+        while (!isEmpty())
+            takeLast();
+    }
+
+    bool isEmpty() const { return m_top == nullptr; }
+
+    void push_back(const TaskAction &action) { m_top = new StackNode{action, m_top}; }
+
+    TaskAction takeLast()
+    {
+        if (isEmpty())
+            throw std::out_of_range("Stack is empty");
+        StackNode *node = m_top;
+        TaskAction action = node->data;
+        m_top = node->next;
+        delete node;
+        return action;
+    }
+
+private:
+    StackNode *m_top;
+};
+
+}
+
+// Queue and stack round trips of real task values, node-per-element
+// against the pooled containers. Each round fills the container and
+// drains it again, as the notification and undo paths do.
+class ContainerBench : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void queue_data() { addRows(); }
+    void queue();
+    void stack_data() { addRows(); }
+    void stack();
+
+private:
+    static void addRows();
+
+    template <typename Container>
+    static qint64 drainQueue(Container &queue, const QVector<Task> &tasks);
+    template <typename Container>
+    static qint64 drainStack(Container &stack, const QVector<Task> &tasks);
+};
+
+void ContainerBench::addRows()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<bool>("pooled");
+    for (int count : benchSizes({1000, 10000, 100000})) {
+        const QByteArray label = sizeLabel(count).toLatin1();
+        QTest::newRow((label + " nodes").constData()) << count << false;
+        QTest::newRow((label + " pooled").constData()) << count << true;
+    }
+}
+
+template <typename Container>
+qint64 ContainerBench::drainQueue(Container &queue, const QVector<Task> &tasks)
+{
+    for (const Task &task : tasks)
+        queue.enqueue(task);
+    qint64 checksum = 0;
+    while (!queue.isEmpty())
+        checksum += queue.dequeue().id;
+    return checksum;
+}
+
+template <typename Container>
+qint64 ContainerBench::drainStack(Container &stack, const QVector<Task> &tasks)
+{
+    for (const Task &task : tasks)
+        stack.push_back({task, TaskActionType::Update});
+    qint64 checksum = 0;
+    while (!stack.isEmpty())
+        checksum += stack.takeLast().task.id;
+    return checksum;
+}
+
+void ContainerBench::queue()
+{
+    QFETCH(int, count);
+    QFETCH(bool, pooled);
+    const QVector<Task> tasks = makeSyntheticTasks(count);
+
+    qint64 checksum = 0;
+    if (pooled) {
+        TaskQueue queue;
+        QBENCHMARK {
+            checksum = drainQueue(queue, tasks);
+        }
+    } else {
+        LinkedTaskQueue queue;
+        QBENCHMARK {
+            checksum = drainQueue(queue, tasks);
+        }
+    }
+    QCOMPARE(checksum, qint64(count) * (count + 1) / 2);
+}
+
+void ContainerBench::stack()
+{
+    QFETCH(int, count);
+    QFETCH(bool, pooled);
+    const QVector<Task> tasks = makeSyntheticTasks(count);
+
+    qint64 checksum = 0;
+    if (pooled) {
+        TaskActionStack stack;
+        QBENCHMARK {
+            checksum = drainStack(stack, tasks);
+        }
+    } else {
+        LinkedStack stack;
+        QBENCHMARK {
+            checksum = drainStack(stack, tasks);
+        }
+    }
+    QCOMPARE(checksum, qint64(count) * (count + 1) / 2);
+}
+
+QTEST_GUILESS_MAIN(ContainerBench)
+#include "bench_containers.moc"
@@ -0,0 +1,105 @@
+#include <QtTest>
+#include <QApplication>
+#include <QTemporaryDir>
+
+#include "mainwindow.h"
+#include "startupprofiler.h"
+#include "benchdata.h"
+
+// Time from constructing MainWindow to the first paint of a populated
+// board, against synthetic databases. Runs on the offscreen platform
+// unless QT_QPA_PLATFORM says otherwise.
+class StartupBench : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void firstBoard_data();
+    void firstBoard();
+
+private:
+    QTemporaryDir m_root;
+    QHash<int, QString> m_databases;
+
+    QString databaseDir(int count);
+    static qint64 timeToFirstBoard();
+};
+
+QString StartupBench::databaseDir(int count)
+{
+    if (m_databases.contains(count))
+        return m_databases.value(count);
+
+    QString dir = m_root.filePath(QString::number(count));
+    if (!QDir().mkpath(dir) || !writeSyntheticDatabase(dir + "/todo.db", count))
+        return QString();
+    m_databases.insert(count, dir);
+    return dir;
+}
+
+qint64 StartupBench::timeToFirstBoard()
+{
+    qint64 painted = -1;
+    QMetaObject::Connection connection = connect(StartupProfiler::instance(), &StartupProfiler::phaseReached,
+                                                 [&painted](const QString &phase, qint64 ns) {
+        if (phase == "first board painted")
+            painted = ns;
+    });
+
+    StartupProfiler::start(false);
+    {
+        MainWindow window;
+        window.show();
+        QMetaObject::invokeMethod(&window, "on_StartButton_clicked");
+        QTest::qWaitFor([&painted]() { return painted >= 0; }, 10 * 60 * 1000);
+    }
+    QObject::disconnect(connection);
+    return painted;
+}
+
+void StartupBench::firstBoard_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<bool>("snapshot");
+    for (int count : benchSizes({1000, 100000, 1000000})) {
+        const QByteArray label = sizeLabel(count).toLatin1();
+        QTest::newRow((label + " sqlite").constData()) << count << false;
+        QTest::newRow((label + " snapshot").constData()) << count << true;
+    }
+}
+
+void StartupBench::firstBoard()
+{
+    QFETCH(int, count);
+    QFETCH(bool, snapshot);
+    QVERIFY(m_root.isValid());
+
+    QString dir = databaseDir(count);
+    QVERIFY2(!dir.isEmpty(), "could not create the synthetic database");
+    QVERIFY(QDir::setCurrent(dir));
+
+    if (snapshot) {
+        qunsetenv("TODO_NO_SNAPSHOT");
+        // A first run writes the snapshot when its window closes.
+        if (!QFile::exists("todo.snapshot"))
+            QVERIFY(timeToFirstBoard() >= 0);
+        QVERIFY(QFile::exists("todo.snapshot"));
+    } else {
+        qputenv("TODO_NO_SNAPSHOT", "1");
+    }
+
+    qint64 ns = timeToFirstBoard();
+    QVERIFY2(ns >= 0, "the board was never painted");
+    QTest::setBenchmarkResult(ns / 1e6, QTest::WalltimeMilliseconds);
+}
+
+int main(int argc, char *argv[])
+{
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+    StartupBench bench;
+    return QTest::qExec(&bench, argc, argv);
+}
+
+#include "bench_startup.moc"
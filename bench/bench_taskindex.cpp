@@ -0,0 +1,45 @@
+#include <QtTest>
+#include <QRandomGenerator>
+
+#include "benchdata.h"
+#include "taskstore.h"
+
+class TaskIndexBench : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void lookup_data();
+    void lookup();
+};
+
+void TaskIndexBench::lookup_data()
+{
+    QTest::addColumn<int>("count");
+    for (int count : benchSizes({1000, 10000, 100000, 1000000}))
+        QTest::newRow(sizeLabel(count).toLatin1().constData()) << count;
+}
+
+void TaskIndexBench::lookup()
+{
+    QFETCH(int, count);
+    TaskStore store;
+    store.reset(makeSyntheticTasks(count));
+
+    QVector<int> probes(4096);
+    QRandomGenerator rng(42);
+    for (int &id : probes)
+        id = rng.bounded(1, count + 1);
+
+    int found = 0;
+    QBENCHMARK {
+        for (int id : probes) {
+            if (store.taskById(id))
+                ++found;
+        }
+    }
+    QVERIFY(found > 0);
+}
+
+QTEST_GUILESS_MAIN(TaskIndexBench)
+#include "bench_taskindex.moc"
@@ -0,0 +1,409 @@
+#include <QtTest>
+#include <QTemporaryDir>
+
+#include "benchdata.h"
+#include "taskcolumnmodel.h"
+#include "taskdag.h"
+#include "taskdependencytracker.h"
+#include "taskexporter.h"
+#include "taskgraph.h"
+#include "taskhistory.h"
+#include "taskorder.h"
+#include "taskrepository.h"
+#include "taskscheduler.h"
+#include "taskstore.h"
+
+// The board's main paths against synthetic databases. Sizes come from
+// TODO_BENCH_SIZES; use -csv or -o file,xml for machine-readable results.
+class TodoBench : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void refresh_data() { addSizes(); }
+    void refresh();
+    void displayTasks_data() { addSizes(); }
+    void displayTasks();
+    void sortByDeadline_data() { addSizes(); }
+    void sortByDeadline();
+    void sortByPriority_data() { addSizes(); }
+    void sortByPriority();
+    void sortedEdits_data() { addSizes(); }
+    void sortedEdits();
+    void permutationSort_data() { addSizes(); }
+    void permutationSort();
+    void search_data() { addSizes(); }
+    void search();
+    void notifications_data() { addSizes(); }
+    void notifications();
+    void dependencyGraph_data() { addSizes(); }
+    void dependencyGraph();
+    void dependencyGraphEdits_data() { addSizes(); }
+    void dependencyGraphEdits();
+    void recommendations_data() { addSizes(); }
+    void recommendations();
+    void dependencyDag_data() { addSizes(); }
+    void dependencyDag();
+    void scheduledRecommendations_data() { addSizes(); }
+    void scheduledRecommendations();
+    void undoRedo_data() { addSizes(); }
+    void undoRedo();
+    void undoJournal_data() { addSizes(); }
+    void undoJournal();
+    void bulkStatus_data() { addSizes(); }
+    void bulkStatus();
+    void exportJson_data() { addSizes(); }
+    void exportJson();
+
+private:
+    // Mirrors MainWindow: one column model per status over the store.
+    struct Board {
+        TaskStore store;
+        TaskDependencyTracker dependencies;
+        TaskScheduler scheduler;
+        TaskColumnModel pending{TaskStatus::Pending};
+        TaskColumnModel inProgress{TaskStatus::InProgress};
+        TaskColumnModel complete{TaskStatus::Complete};
+
+        Board();
+        void setOrder(TaskOrder order);
+    };
+
+    QTemporaryDir m_root;
+    QHash<int, QString> m_databases;
+
+    static void addSizes();
+    QString database(int count);
+    bool open(TaskRepository &repo, int count);
+};
+
+TodoBench::Board::Board()
+{
+    dependencies.setStore(&store);
+    scheduler.setStore(&store);
+    for (TaskColumnModel *column : {&pending, &inProgress, &complete})
+        column->setStore(&store);
+}
+
+void TodoBench::Board::setOrder(TaskOrder order)
+{
+    for (TaskColumnModel *column : {&pending, &inProgress, &complete})
+        column->setOrder(order);
+}
+
+void TodoBench::initTestCase()
+{
+    QVERIFY(m_root.isValid());
+}
+
+void TodoBench::addSizes()
+{
+    QTest::addColumn<int>("count");
+    for (int count : benchSizes({1000, 10000, 100000}))
+        QTest::newRow(sizeLabel(count).toLatin1().constData()) << count;
+}
+
+QString TodoBench::database(int count)
+{
+    if (!m_databases.contains(count)) {
+        QString path = m_root.filePath(QString("todo-%1.db").arg(count));
+        if (!writeSyntheticDatabase(path, count))
+            return QString();
+        m_databases.insert(count, path);
+    }
+    return m_databases.value(count);
+}
+
+bool TodoBench::open(TaskRepository &repo, int count)
+{
+    QString path = database(count);
+    return !path.isEmpty() && repo.open(path);
+}
+
+void TodoBench::refresh()
+{
+    QFETCH(int, count);
+    TaskRepository repo("todo-bench");
+    QVERIFY(open(repo, count));
+    Board board;
+
+    QVector<Task> tasks;
+    QBENCHMARK {
+        QVERIFY(repo.loadTasks(TaskOrder::ById, &tasks));
+        board.store.reset(tasks);
+    }
+    QCOMPARE(board.store.tasks().size(), count);
+}
+
+void TodoBench::displayTasks()
+{
+    QFETCH(int, count);
+    const QVector<Task> tasks = makeSyntheticTasks(count);
+
+    QBENCHMARK {
+        Board board;
+        board.store.reset(tasks);
+        board.scheduler.recommend(5);
+    }
+}
+
+void TodoBench::sortByDeadline()
+{
+    QFETCH(int, count);
+    Board board;
+    board.store.reset(makeSyntheticTasks(count));
+
+    // Always switch from another order, as a click would.
+    QBENCHMARK {
+        board.setOrder(TaskOrder::ById);
+        board.setOrder(TaskOrder::ByDueDate);
+    }
+}
+
+void TodoBench::sortByPriority()
+{
+    QFETCH(int, count);
+    Board board;
+    board.store.reset(makeSyntheticTasks(count));
+
+    QBENCHMARK {
+        board.setOrder(TaskOrder::ById);
+        board.setOrder(TaskOrder::ByPriority);
+    }
+}
+
+void TodoBench::sortedEdits()
+{
+    QFETCH(int, count);
+    Board board;
+    board.store.reset(makeSyntheticTasks(count));
+    board.setOrder(TaskOrder::ByPriority);
+    const int edits = qMin(count, 1000);
+
+    // Each edit moves one row within every order of its column.
+    int round = 0;
+    QBENCHMARK {
+        ++round;
+        for (int i = 0; i < edits; ++i) {
+            Task task = *board.store.taskById(i + 1);
+            task.priority = (task.priority + 1) % 6;
+            task.dueDay += round % 2 ? 3 : -3;
+            board.store.updateTask(task);
+        }
+    }
+}
+
+void TodoBench::permutationSort()
+{
+    QFETCH(int, count);
+    QVector<TaskSortEntry> shuffled(count);
+    quint32 seed = 1;
+    for (int i = 0; i < count; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        shuffled[i] = taskSortEntry(TaskOrder::ByPriority, i + 1, qint32(seed >> 8) % 3650, int(seed % 6));
+    }
+
+    QVector<TaskSortEntry> entries;
+    QBENCHMARK {
+        entries = shuffled;
+        parallelStableSort(entries);
+    }
+    QVERIFY(std::is_sorted(entries.begin(), entries.end()));
+}
+
+void TodoBench::search()
+{
+    QFETCH(int, count);
+    TaskRepository repo("todo-bench");
+    QVERIFY(open(repo, count));
+
+    int hits = 0;
+    QBENCHMARK {
+        hits = 0;
+        repo.search("review bud", 1000, [&hits](const SearchHit &) {
+            ++hits;
+            return true;
+        });
+    }
+    QVERIFY(hits > 0);
+}
+
+void TodoBench::notifications()
+{
+    QFETCH(int, count);
+    TaskRepository repo("todo-bench");
+    QVERIFY(open(repo, count));
+    const QDate dueBy(2025, 1, 31);
+
+    QVector<Task> due;
+    QBENCHMARK {
+        QVERIFY(repo.loadOpenTasksDueBy(dueBy, &due));
+    }
+    QVERIFY(!due.isEmpty());
+}
+
+void TodoBench::dependencyGraph()
+{
+    QFETCH(int, count);
+    const QVector<Task> tasks = makeSyntheticTasks(count);
+
+    TaskDependencyGraph graph;
+    QBENCHMARK {
+        graph = buildTaskDependencyGraph(tasks);
+    }
+    QCOMPARE(graph.size(), count);
+}
+
+void TodoBench::dependencyGraphEdits()
+{
+    QFETCH(int, count);
+    Board board;
+    board.store.reset(makeSyntheticTasks(count));
+    board.dependencies.graph();
+    const int edits = qMin(count, 1000);
+
+    // Alternately retitles a task and points its description at another.
+    int round = 0;
+    QBENCHMARK {
+        ++round;
+        for (int i = 0; i < edits; ++i) {
+            Task task = *board.store.taskById(i + 1);
+            if (i % 2)
+                task.title = QString("Renamed task %1 round %2").arg(i).arg(round);
+            else
+                task.description = "Needs " + board.store.tasks().at((i * 7919 + round) % count).title + " first";
+            board.store.updateTask(task);
+            board.dependencies.graph();
+        }
+    }
+}
+
+void TodoBench::recommendations()
+{
+    QFETCH(int, count);
+    const QVector<Task> tasks = makeSyntheticTasks(count);
+    const TaskDependencyGraph graph = buildTaskDependencyGraph(tasks);
+
+    QVector<Task> recs;
+    QBENCHMARK {
+        recs = recommendTasks(tasks, graph, 5);
+    }
+    QVERIFY(!recs.isEmpty());
+}
+
+void TodoBench::dependencyDag()
+{
+    QFETCH(int, count);
+    const QVector<TaskDependency> edges = makeSyntheticDependencies(makeSyntheticTasks(count));
+
+    // Edges one at a time, each checked for a cycle as it is added.
+    TaskDag dag;
+    QBENCHMARK {
+        dag = TaskDag();
+        for (const TaskDependency &edge : edges)
+            dag.addDependency(edge.taskId, edge.dependsOn);
+    }
+    QCOMPARE(dag.edgeCount(), edges.size());
+}
+
+void TodoBench::scheduledRecommendations()
+{
+    QFETCH(int, count);
+    const QVector<Task> tasks = makeSyntheticTasks(count);
+    Board board;
+    board.store.reset(tasks);
+    board.store.resetDependencies(makeSyntheticDependencies(tasks));
+    QVERIFY(board.scheduler.readyCount() > 0);
+
+    // A status change only touches the counters of the task's dependents.
+    QVector<Task> recs;
+    int id = 0;
+    QBENCHMARK {
+        id = id % count + 1;
+        board.store.setStatus(id, board.store.taskById(id)->status == TaskStatus::Complete ? TaskStatus::Pending : TaskStatus::Complete);
+        recs = board.scheduler.recommend(5);
+    }
+    QVERIFY(!recs.isEmpty());
+}
+
+void TodoBench::undoRedo()
+{
+    QFETCH(int, count);
+    Board board;
+    board.store.reset(makeSyntheticTasks(count));
+    const int edits = qMin(count, 1000);
+
+    QBENCHMARK {
+        TaskHistory history(&board.store);
+        for (int id = 1; id <= edits; ++id)
+            history.setStatus(id, board.store.taskById(id)->status == TaskStatus::Complete ? TaskStatus::Pending : TaskStatus::Complete);
+        while (history.undo()) {}
+        while (history.redo()) {}
+        while (history.undo()) {}
+    }
+}
+
+void TodoBench::undoJournal()
+{
+    QFETCH(int, count);
+    Board board;
+    board.store.reset(makeSyntheticTasks(count));
+    const qint64 budget = 256 * 1024;
+
+    // A long session of description edits, a grouped pair at a time,
+    // against a small budget: the oldest steps fall off the front.
+    TaskHistory history(&board.store, budget);
+    int round = 0;
+    QBENCHMARK {
+        ++round;
+        for (int id = 1; id < count; id += 2) {
+            history.beginGroup();
+            for (int other : {id, id + 1}) {
+                Task task = *board.store.taskById(other);
+                task.description = QString("Edited in round %1: ").arg(round) + task.title;
+                history.updateTask(task);
+            }
+            history.endGroup();
+        }
+    }
+    QVERIFY(history.byteSize() <= budget);
+    QVERIFY(history.undo());
+}
+
+void TodoBench::bulkStatus()
+{
+    QFETCH(int, count);
+    Board board;
+    board.store.reset(makeSyntheticTasks(count));
+    QVector<int> selection;
+    for (int id = 1; id <= qMin(count, 1000); ++id)
+        selection.push_back(id);
+
+    // A multi-select move and its undo: one tasksChanged each, however
+    // large the selection.
+    TaskHistory history(&board.store);
+    QBENCHMARK {
+        QVERIFY(history.setStatuses(selection, TaskStatus::Complete) > 0);
+        QVERIFY(history.undo());
+        history.clear();
+    }
+}
+
+void TodoBench::exportJson()
+{
+    QFETCH(int, count);
+    TaskRepository repo("todo-bench");
+    QVERIFY(open(repo, count));
+    const QString path = m_root.filePath("export.json");
+
+    TaskExporter exporter(repo);
+    QBENCHMARK {
+        QVERIFY(exporter.exportFile(path));
+    }
+    QCOMPARE(exporter.exportedCount(), count);
+}
+
+QTEST_GUILESS_MAIN(TodoBench)
+#include "bench_todo.moc"
@@ -0,0 +1,85 @@
+#include "benchdata.h"
+#include "taskrepository.h"
+#include <QDate>
+#include <QHash>
+#include <QRandomGenerator>
+#include <QStringList>
+
+QVector<Task> makeSyntheticTasks(int count)
+{
+    static const char *const verbs[] = {"Draft", "Review", "Ship", "Plan", "Fix", "Write", "Test", "Book"};
+    static const char *const nouns[] = {"budget", "report", "release", "meeting", "invoice", "slides", "backup", "trip"};
+    static const TaskStatus statuses[] = {TaskStatus::Pending, TaskStatus::InProgress, TaskStatus::Complete};
+    const QDate base(2025, 1, 1);
+
+    QRandomGenerator rng(42);
+    QVector<Task> tasks;
+    tasks.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        Task t;
+        t.id = i + 1;
+        t.title = QString("%1 %2 %3").arg(verbs[rng.bounded(8)]).arg(nouns[rng.bounded(8)]).arg(i + 1);
+        if (i > 0 && rng.bounded(8) == 0)
+            t.description = "Needs " + tasks[rng.bounded(i)].title + " first";
+        else
+            t.description = "Synthetic benchmark task";
+        t.dueDay = qint32(base.toJulianDay()) + qint32(rng.bounded(365));
+        t.subTasks = QStringList{"First step", "Second step"};
+        t.priority = rng.bounded(6);
+        t.status = statuses[rng.bounded(3)];
+        tasks.push_back(t);
+    }
+    return tasks;
+}
+
+QVector<TaskDependency> makeSyntheticDependencies(const QVector<Task> &tasks)
+{
+    QHash<QString, int> idByTitle;
+    QVector<TaskDependency> edges;
+    for (const Task &t : tasks) {
+        idByTitle.insert(t.title, t.id);
+        if (!t.description.startsWith("Needs "))
+            continue;
+        const QString title = t.description.mid(6, t.description.size() - 12);
+        const int dependsOn = idByTitle.value(title, -1);
+        if (dependsOn != -1)
+            edges.push_back(TaskDependency{t.id, dependsOn});
+    }
+    return edges;
+}
+
+bool writeSyntheticDatabase(const QString &path, int count)
+{
+    TaskRepository repo("bench-setup");
+    if (!repo.open(path) || !repo.beginTransaction())
+        return false;
+    for (const Task &t : makeSyntheticTasks(count)) {
+        if (repo.insertImportedTask(t) == -1) {
+            repo.rollbackTransaction();
+            return false;
+        }
+    }
+    return repo.commitTransaction();
+}
+
+QVector<int> benchSizes(const QVector<int> &fallback)
+{
+    QVector<int> sizes;
+    const QStringList parts = QString::fromLocal8Bit(qgetenv("TODO_BENCH_SIZES")).split(',');
+    for (const QString &part : parts) {
+        bool ok = false;
+        int n = part.trimmed().toInt(&ok);
+        if (ok && n > 0)
+            sizes.push_back(n);
+    }
+    return sizes.isEmpty() ? fallback : sizes;
+}
+
+QString sizeLabel(int count)
+{
+    if (count >= 1000000 && count % 1000000 == 0)
+        return QString::number(count / 1000000) + "M";
+    if (count >= 1000 && count % 1000 == 0)
+        return QString::number(count / 1000) + "k";
+    return QString::number(count);
+}
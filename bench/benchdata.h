@@ -0,0 +1,25 @@
+#ifndef BENCHDATA_H
+#define BENCHDATA_H
+
+#include <QString>
+#include <QVector>
+
+#include "task.h"
+
+// Deterministic synthetic tasks for the benchmarks. Titles are drawn from
+// a small vocabulary and roughly one description in eight mentions an
+// earlier task's title, so search and the dependency graph have work to do.
+QVector<Task> makeSyntheticTasks(int count);
+
+// One explicit dependency per description that mentions another task,
+// always on an earlier task, so the edges are acyclic.
+QVector<TaskDependency> makeSyntheticDependencies(const QVector<Task> &tasks);
+
+// Creates a todo.db at path holding makeSyntheticTasks(count).
+bool writeSyntheticDatabase(const QString &path, int count);
+
+// Sizes listed in TODO_BENCH_SIZES (e.g. "1000,100000"), else fallback.
+QVector<int> benchSizes(const QVector<int> &fallback);
+QString sizeLabel(int count);
+
+#endif // BENCHDATA_H
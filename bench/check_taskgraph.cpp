@@ -0,0 +1,215 @@
+#include <QtTest>
+#include <QRandomGenerator>
+#include <algorithm>
+
+#include "taskgraph.h"
+
+namespace {
+
+// Short words that overlap each other, so titles occur inside titles and
+// the matcher's failure and output links get real work. Mixed case,
+// non-ASCII included.
+const char *const kWords[] = {
+    "a", "ab", "abc", "b", "bc", "ca", "Plan", "plan b", "Straße", "ΣΟΦΟΣ", "σοφος", "Éclair", "éclair au",
+};
+const int kWordCount = int(sizeof(kWords) / sizeof(kWords[0]));
+
+QString randomText(QRandomGenerator &rng, int maxWords)
+{
+    QStringList words;
+    const int count = rng.bounded(maxWords + 1);
+    for (int i = 0; i < count; ++i)
+        words.append(QString::fromUtf8(kWords[rng.bounded(kWordCount)]));
+    return words.join(rng.bounded(2) ? " " : "");
+}
+
+QVector<Task> randomTasks(QRandomGenerator &rng, int count)
+{
+    QVector<Task> tasks;
+    for (int i = 0; i < count; ++i) {
+        Task t = {};
+        t.id = i + 1;
+        t.title = randomText(rng, 2);
+        t.description = randomText(rng, 4);
+        t.dueDay = kNoDueDay;
+        tasks.push_back(t);
+    }
+    return tasks;
+}
+
+// What the graph should hold for task, by a plain substring test against
+// every other title: the same lowercasing, and never the task itself or
+// a task with the same title.
+QVector<int> bruteForceDependencies(const Task &task, const QVector<Task> &tasks)
+{
+    const QString title = task.title.toLower();
+    const QString description = task.description.toLower();
+    QVector<int> deps;
+    for (const Task &other : tasks) {
+        const QString otherTitle = other.title.toLower();
+        if (otherTitle.isEmpty() || otherTitle == title)
+            continue;
+        if (title.contains(otherTitle) || description.contains(otherTitle))
+            deps.push_back(other.id);
+    }
+    std::sort(deps.begin(), deps.end());
+    return deps;
+}
+
+// Like randomTasks(), but a third of the titles carry a word of their own,
+// so edits keep adding titles the matcher has not seen.
+Task randomEditedTask(QRandomGenerator &rng, int id, int maxId)
+{
+    Task t = {};
+    t.id = id;
+    t.title = randomText(rng, 2);
+    if (rng.bounded(3) == 0)
+        t.title += QString(" Ω%1").arg(id);
+    t.description = randomText(rng, 3);
+    if (rng.bounded(3) == 0)
+        t.description += QString(" ω%1").arg(1 + rng.bounded(maxId));
+    t.dueDay = kNoDueDay;
+    return t;
+}
+
+QVector<int> graphDependencies(const TaskDependencyGraph &graph, int id)
+{
+    const TaskDependencyGraph::Range range = graph.dependenciesOf(id);
+    QVector<int> deps(range.begin(), range.end());
+    std::sort(deps.begin(), deps.end());
+    return deps;
+}
+
+}
+
+// TitleMatcher and TaskDependencyGraph against brute-force substring
+// scans on randomized titles and texts.
+class TaskGraphCheck : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void matcherFindsEveryTitle();
+    void buildMatchesBruteForce();
+    void namesakesAreIndependent();
+    void editsMatchRebuild();
+
+private:
+    static void compareWithRebuild(const TaskDependencyGraph &graph, const QVector<Task> &tasks);
+};
+
+void TaskGraphCheck::matcherFindsEveryTitle()
+{
+    QRandomGenerator rng(17);
+    for (int round = 0; round < 200; ++round) {
+        QVector<QString> titles;
+        const int count = 1 + rng.bounded(8);
+        for (int i = 0; i < count; ++i)
+            titles.push_back(randomText(rng, 2).toLower());
+
+        TitleMatcher matcher;
+        matcher.build(titles);
+        for (int probe = 0; probe < 20; ++probe) {
+            const QString text = randomText(rng, 6);
+            QVector<int> found;
+            matcher.match(text, [&found](int index) { found.push_back(index); });
+
+            // Each distinct title once, under the index it first appears at.
+            QVector<int> expected;
+            const QString lower = text.toLower();
+            for (int i = 0; i < titles.size(); ++i) {
+                if (!titles[i].isEmpty() && titles.indexOf(titles[i]) == i && lower.contains(titles[i]))
+                    expected.push_back(i);
+            }
+            QVector<int> foundTitles;
+            for (int index : found)
+                foundTitles.push_back(titles.indexOf(titles[index]));
+            std::sort(foundTitles.begin(), foundTitles.end());
+            QCOMPARE(foundTitles.size(), found.size());
+            QCOMPARE(foundTitles, expected);
+        }
+    }
+}
+
+void TaskGraphCheck::buildMatchesBruteForce()
+{
+    QRandomGenerator rng(42);
+    for (int round = 0; round < 20; ++round) {
+        const QVector<Task> tasks = randomTasks(rng, 1 + rng.bounded(60));
+        const TaskDependencyGraph graph = TaskDependencyGraph::build(tasks);
+        QCOMPARE(graph.size(), tasks.size());
+        for (const Task &task : tasks)
+            QCOMPARE(graphDependencies(graph, task.id), bruteForceDependencies(task, tasks));
+    }
+}
+
+void TaskGraphCheck::namesakesAreIndependent()
+{
+    QVector<Task> tasks(3);
+    for (int i = 0; i < tasks.size(); ++i) {
+        tasks[i] = {};
+        tasks[i].id = i + 1;
+        tasks[i].dueDay = kNoDueDay;
+    }
+    tasks[0].title = "Review budget";
+    tasks[1].title = "review BUDGET";
+    tasks[2].title = "Ship";
+    tasks[2].description = "After the review budget";
+
+    const TaskDependencyGraph graph = TaskDependencyGraph::build(tasks);
+    QVERIFY(graph.dependenciesOf(1).isEmpty());
+    QVERIFY(graph.dependenciesOf(2).isEmpty());
+    QCOMPARE(graphDependencies(graph, 3), QVector<int>({1, 2}));
+}
+
+void TaskGraphCheck::compareWithRebuild(const TaskDependencyGraph &graph, const QVector<Task> &tasks)
+{
+    const TaskDependencyGraph rebuilt = TaskDependencyGraph::build(tasks);
+    QCOMPARE(graph.size(), tasks.size());
+    for (const Task &task : tasks) {
+        const QVector<int> deps = graphDependencies(graph, task.id);
+        QCOMPARE(deps, graphDependencies(rebuilt, task.id));
+        QCOMPARE(deps, bruteForceDependencies(task, tasks));
+    }
+}
+
+// Random inserts, edits and removals patched in one at a time must end
+// where a full build would. Enough rows are patched to pack them again
+// and enough new titles arrive to rebuild the matcher along the way.
+void TaskGraphCheck::editsMatchRebuild()
+{
+    QRandomGenerator rng(18);
+    int nextId = 1;
+    QVector<Task> tasks;
+    for (; nextId <= 1200; ++nextId)
+        tasks.push_back(randomEditedTask(rng, nextId, nextId));
+    TaskDependencyGraph graph = TaskDependencyGraph::build(tasks);
+
+    const int steps = 3000;
+    for (int step = 1; step <= steps; ++step) {
+        const int op = tasks.isEmpty() ? 0 : rng.bounded(4);
+        if (op == 0) {
+            tasks.push_back(randomEditedTask(rng, nextId, nextId));
+            ++nextId;
+            graph.insertTask(tasks.last(), tasks);
+        } else if (op == 1) {
+            const int index = rng.bounded(tasks.size());
+            const int id = tasks[index].id;
+            tasks.remove(index);
+            graph.removeTask(id);
+        } else {
+            const int index = rng.bounded(tasks.size());
+            const Task edited = randomEditedTask(rng, tasks[index].id, nextId);
+            if (op == 2)
+                tasks[index].title = edited.title;
+            else
+                tasks[index].description = edited.description;
+            graph.updateTask(tasks[index], tasks);
+        }
+        if (step % 500 == 0)
+            compareWithRebuild(graph, tasks);
+    }
+}
+
+QTEST_GUILESS_MAIN(TaskGraphCheck)
+#include "check_taskgraph.moc"
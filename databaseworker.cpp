@@ -0,0 +1,296 @@
+#include "databaseworker.h"
+#include "taskimporter.h"
+#include "taskexporter.h"
+#include "tasksnapshot.h"
+#include <QDebug>
+#include <QThread>
+
+DatabaseWorker::DatabaseWorker(QObject *parent)
+    : QObject(parent), m_searchGeneration(0), m_importCancelled(false), m_exportCancelled(false)
+{
+    qRegisterMetaType<Task>("Task");
+    qRegisterMetaType<QVector<Task>>("QVector<Task>");
+    qRegisterMetaType<QVector<TaskDependency>>("QVector<TaskDependency>");
+    qRegisterMetaType<QVector<TaskAction>>("QVector<TaskAction>");
+    qRegisterMetaType<QVector<SearchHit>>("QVector<SearchHit>");
+}
+
+void DatabaseWorker::reportFailure(bool wasWrite)
+{
+    emit requestFailed(m_repo ? m_repo->lastError() : QString("Database is not open."), wasWrite);
+}
+
+void DatabaseWorker::requestOpen(const QString &path)
+{
+    QMetaObject::invokeMethod(this, [this, path]() {
+        if (!m_repo)
+            m_repo.reset(new TaskRepository("todo-worker"));
+        bool ok = m_repo->open(path);
+        emit opened(ok, m_repo->searchIndexReady(), m_repo->lastError());
+    }, Qt::QueuedConnection);
+}
+
+void DatabaseWorker::requestLoad(TaskOrder order)
+{
+    QMetaObject::invokeMethod(this, [this, order]() {
+        QVector<Task> tasks;
+        if (!m_repo || !m_repo->loadTasks(order, &tasks))
+            return reportFailure(false);
+        emit tasksLoaded(tasks);
+    }, Qt::QueuedConnection);
+}
+
+void DatabaseWorker::requestLoadIfChanged(qint64 snapshotRevision)
+{
+    QMetaObject::invokeMethod(this, [this, snapshotRevision]() {
+        if (!m_repo)
+            return reportFailure(false);
+        // The snapshot stays up when the revision cannot be read.
+        const qint64 revision = m_repo->revision();
+        if (revision < 0 || revision == snapshotRevision)
+            return;
+        QVector<Task> tasks;
+        if (!m_repo->loadTasks(TaskOrder::ById, &tasks))
+            return reportFailure(false);
+        emit tasksLoaded(tasks);
+    }, Qt::QueuedConnection);
+}
+
+void DatabaseWorker::requestOpenTasksDueBy(const QDate &date)
+{
+    QMetaObject::invokeMethod(this, [this, date]() {
+        QVector<Task> tasks;
+        if (!m_repo || !m_repo->loadOpenTasksDueBy(date, &tasks))
+            return reportFailure(false);
+        emit openTasksDueLoaded(tasks);
+    }, Qt::QueuedConnection);
+}
+
+void DatabaseWorker::requestInsert(const Task &task)
+{
+    QMetaObject::invokeMethod(this, [this, task]() {
+        if (!m_repo)
+            return reportFailure();
+        int id = m_repo->insertTask(task);
+        if (id == -1)
+            return reportFailure();
+        Task inserted = task;
+        inserted.id = id;
+        inserted.status = TaskStatus::Pending;
+        emit taskInserted(inserted);
+    }, Qt::QueuedConnection);
+}
+
+void DatabaseWorker::requestRestore(const Task &task, const QVector<TaskDependency> &edges)
+{
+    requestRestoreTasks(QVector<Task>{task}, edges);
+}
+
+void DatabaseWorker::requestUpdate(const Task &task)
+{
+    QMetaObject::invokeMethod(this, [this, task]() {
+        if (!m_repo || !m_repo->updateTask(task))
+            reportFailure();
+    }, Qt::QueuedConnection);
+}
+
+void DatabaseWorker::requestStatus(int id, TaskStatus status)
+{
+    QMetaObject::invokeMethod(this, [this, id, status]() {
+        if (!m_repo || !m_repo->updateStatus(id, status))
+            reportFailure();
+    }, Qt::QueuedConnection);
+}
+
+void DatabaseWorker::requestRemove(int id)
+{
+    QMetaObject::invokeMethod(this, [this, id]() {
+        if (!m_repo || !m_repo->removeTask(id))
+            reportFailure();
+    }, Qt::QueuedConnection);
+}
+
+void DatabaseWorker::requestStatuses(const QVector<int> &ids, TaskStatus status)
+{
+    QMetaObject::invokeMethod(this, [this, ids, status]() {
+        bool ok = m_repo && m_repo->inTransaction([&]() {
+            for (int id : ids) {
+                if (!m_repo->updateStatus(id, status))
+                    return false;
+            }
+            return true;
+        });
+        if (!ok)
+            reportFailure();
+    }, Qt::QueuedConnection);
+}
+
+void DatabaseWorker::requestRemoveTasks(const QVector<int> &ids)
+{
+    QMetaObject::invokeMethod(this, [this, ids]() {
+        bool ok = m_repo && m_repo->inTransaction([&]() {
+            for (int id : ids) {
+                if (!m_repo->removeTask(id))
+                    return false;
+            }
+            return true;
+        });
+        if (!ok)
+            reportFailure();
+    }, Qt::QueuedConnection);
+}
+
+void DatabaseWorker::requestRestoreTasks(const QVector<Task> &tasks, const QVector<TaskDependency> &edges)
+{
+    QMetaObject::invokeMethod(this, [this, tasks, edges]() {
+        bool ok = m_repo && m_repo->inTransaction([&]() {
+            for (const Task &task : tasks) {
+                if (!m_repo->restoreTask(task))
+                    return false;
+            }
+            for (const TaskDependency &edge : edges) {
+                if (!m_repo->addDependency(edge.taskId, edge.dependsOn))
+                    return false;
+            }
+            return true;
+        });
+        if (!ok)
+            reportFailure();
+    }, Qt::QueuedConnection);
+}
+
+void DatabaseWorker::requestLoadDependencies()
+{
+    QMetaObject::invokeMethod(this, [this]() {
+        QVector<TaskDependency> edges;
+        if (!m_repo || !m_repo->loadDependencies(&edges))
+            return reportFailure(false);
+        emit dependenciesLoaded(edges);
+    }, Qt::QueuedConnection);
+}
+
+void DatabaseWorker::requestAddDependency(int taskId, int dependsOn)
+{
+    QMetaObject::invokeMethod(this, [this, taskId, dependsOn]() {
+        if (!m_repo || !m_repo->addDependency(taskId, dependsOn))
+            reportFailure();
+    }, Qt::QueuedConnection);
+}
+
+void DatabaseWorker::requestRemoveDependency(int taskId, int dependsOn)
+{
+    QMetaObject::invokeMethod(this, [this, taskId, dependsOn]() {
+        if (!m_repo || !m_repo->removeDependency(taskId, dependsOn))
+            reportFailure();
+    }, Qt::QueuedConnection);
+}
+
+void DatabaseWorker::requestLoadHistory()
+{
+    QMetaObject::invokeMethod(this, [this]() {
+        if (!m_repo)
+            return reportFailure(false);
+        QVector<TaskAction> undo, redo;
+        if (m_repo->loadHistory(&undo, &redo))
+            emit historyLoaded(undo, redo);
+    }, Qt::QueuedConnection);
+}
+
+void DatabaseWorker::requestSearch(quint64 generation, const QString &text)
+{
+    cancelSearches(generation);
+    QMetaObject::invokeMethod(this, [this, generation, text]() {
+        runSearch(generation, text);
+    }, Qt::QueuedConnection);
+}
+
+void DatabaseWorker::runSearch(quint64 generation, const QString &text)
+{
+    if (generation != m_searchGeneration.load())
+        return;
+    if (!m_repo) {
+        emit searchResults(generation, QVector<SearchHit>(), true);
+        return;
+    }
+
+    QVector<SearchHit> page;
+    page.reserve(kSearchPageSize);
+    bool finished = m_repo->search(text, kMaxSearchResults, [&](const SearchHit &hit) {
+        if (generation != m_searchGeneration.load())
+            return false;
+        page.push_back(hit);
+        if (page.size() == kSearchPageSize) {
+            emit searchResults(generation, page, false);
+            page.clear();
+        }
+        return true;
+    });
+
+    // A failed query still ends the search, with whatever it found.
+    if (finished || generation == m_searchGeneration.load())
+        emit searchResults(generation, page, true);
+}
+
+void DatabaseWorker::requestImport(const QString &path)
+{
+    m_importCancelled.store(false);
+    QMetaObject::invokeMethod(this, [this, path]() {
+        if (!m_repo) {
+            emit importFinished(false, 0, "Database is not open.");
+            return;
+        }
+        TaskImporter importer(*m_repo);
+        bool ok = importer.importFile(path, [this](qint64 bytesRead, qint64 totalBytes, int imported) {
+            emit importProgress(bytesRead, totalBytes, imported);
+            return !m_importCancelled.load();
+        });
+        emit importFinished(ok, importer.importedCount(), importer.errorString());
+    }, Qt::QueuedConnection);
+}
+
+void DatabaseWorker::requestExport(const QString &path)
+{
+    m_exportCancelled.store(false);
+    QMetaObject::invokeMethod(this, [this, path]() {
+        if (!m_repo) {
+            emit exportFinished(false, 0, "Database is not open.");
+            return;
+        }
+        TaskExporter exporter(*m_repo);
+        bool ok = exporter.exportFile(path, [this](int written, int total) {
+            emit exportProgress(written, total);
+            return !m_exportCancelled.load();
+        });
+        emit exportFinished(ok, exporter.exportedCount(), exporter.errorString());
+    }, Qt::QueuedConnection);
+}
+
+void DatabaseWorker::writeSnapshot(const QString &path)
+{
+    if (!thread()->isRunning())
+        return;
+    QMetaObject::invokeMethod(this, [this, path]() {
+        if (!m_repo)
+            return;
+        qint64 revision = m_repo->revision();
+        if (revision < 0 || revision == TaskSnapshot::readRevision(path))
+            return;
+        TaskSnapshotWriter writer;
+        bool ok = m_repo->forEachTask([&writer](const Task &task) { writer.add(task); return true; });
+        if (!ok)
+            return;
+        QString error;
+        if (!writer.write(path, revision, &error))
+            qWarning() << "Could not write task snapshot:" << error;
+    }, Qt::BlockingQueuedConnection);
+}
+
+void DatabaseWorker::saveHistory(const QVector<TaskAction> &undo, const QVector<TaskAction> &redo)
+{
+    if (!thread()->isRunning())
+        return;
+    QMetaObject::invokeMethod(this, [this, undo, redo]() {
+        if (m_repo && !m_repo->saveHistory(undo, redo))
+            qWarning() << "Could not save undo history:" << m_repo->lastError();
+    }, Qt::BlockingQueuedConnection);
+}
@@ -0,0 +1,90 @@
+#ifndef DATABASEWORKER_H
+#define DATABASEWORKER_H
+
+#include <QDate>
+#include <QObject>
+#include <QScopedPointer>
+#include <QString>
+#include <QVector>
+#include <atomic>
+
+#include "task.h"
+#include "taskrepository.h"
+#include "tasksearch.h"
+
+// Owns the SQLite connection and runs every query on its own thread.
+// The request*() methods may be called from any thread; they queue the
+// work and return immediately, and results come back through signals.
+class DatabaseWorker : public QObject {
+    Q_OBJECT
+
+public:
+    explicit DatabaseWorker(QObject *parent = nullptr);
+
+    void requestOpen(const QString &path);
+    void requestLoad(TaskOrder order = TaskOrder::ById);
+    // Reloads only if the database has moved past the snapshot's revision.
+    void requestLoadIfChanged(qint64 snapshotRevision);
+    void requestOpenTasksDueBy(const QDate &date);
+    void requestInsert(const Task &task);
+    // The task and its edges in one transaction.
+    void requestRestore(const Task &task, const QVector<TaskDependency> &edges);
+    void requestUpdate(const Task &task);
+    void requestStatus(int id, TaskStatus status);
+    void requestRemove(int id);
+    // Bulk edits, each in a single transaction.
+    void requestStatuses(const QVector<int> &ids, TaskStatus status);
+    void requestRemoveTasks(const QVector<int> &ids);
+    void requestRestoreTasks(const QVector<Task> &tasks, const QVector<TaskDependency> &edges);
+    void requestLoadDependencies();
+    void requestAddDependency(int taskId, int dependsOn);
+    void requestRemoveDependency(int taskId, int dependsOn);
+    void requestLoadHistory();
+
+    // A new search cancels any older one still scanning.
+    void requestSearch(quint64 generation, const QString &text);
+    void cancelSearches(quint64 generation) { m_searchGeneration.store(generation); }
+
+    void requestImport(const QString &path);
+    void cancelImport() { m_importCancelled.store(true); }
+
+    void requestExport(const QString &path);
+    void cancelExport() { m_exportCancelled.store(true); }
+
+    // Runs every request queued so far, then rewrites the snapshot from the
+    // database unless it is already current. Blocks the caller.
+    void writeSnapshot(const QString &path);
+    // Runs every request queued so far, then saves the undo history.
+    // Blocks the caller.
+    void saveHistory(const QVector<TaskAction> &undo, const QVector<TaskAction> &redo);
+
+signals:
+    void opened(bool ok, bool searchIndexReady, const QString &error);
+    void tasksLoaded(const QVector<Task> &tasks);
+    void openTasksDueLoaded(const QVector<Task> &tasks);
+    void taskInserted(const Task &task);
+    void dependenciesLoaded(const QVector<TaskDependency> &edges);
+    void historyLoaded(const QVector<TaskAction> &undo, const QVector<TaskAction> &redo);
+    void searchResults(quint64 generation, const QVector<SearchHit> &hits, bool done);
+    void importProgress(qint64 bytesRead, qint64 totalBytes, int imported);
+    void importFinished(bool ok, int imported, const QString &error);
+    void exportProgress(int written, int total);
+    void exportFinished(bool ok, int exported, const QString &error);
+    // wasWrite is false for a failed read, which changes nothing and
+    // leaves whatever was loaded before in place.
+    void requestFailed(const QString &error, bool wasWrite);
+
+private:
+    QScopedPointer<TaskRepository> m_repo;
+    std::atomic<quint64> m_searchGeneration;
+    std::atomic<bool> m_importCancelled;
+    std::atomic<bool> m_exportCancelled;
+
+    void runSearch(quint64 generation, const QString &text);
+    void reportFailure(bool wasWrite = true);
+
+    static const int kSearchPageSize = 50;
+    static const int kMaxSearchResults = 1000;
+};
+
+#endif // DATABASEWORKER_H
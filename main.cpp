@@ -1,14 +1,25 @@
 #include "mainwindow.h"
+#include "startupprofiler.h"
 
 #include <QApplication>
 #include <QPalette>
 #include <QColor>
+#include <QTimer>
+#include <cstring>
 
 int main(int argc, char *argv[])
 {
+    bool trace = false;
+    for (int i = 1; i < argc; ++i)
+        trace = trace || std::strcmp(argv[i], "--startup-trace") == 0;
+    StartupProfiler::start(trace);
+
     QApplication a(argc, argv);
+    StartupProfiler::mark("application created");
     MainWindow w;
+    StartupProfiler::mark("main window constructed");
     w.show();
+    StartupProfiler::mark("window shown");
 
     QPalette darkPalette;
     darkPalette.setColor(QPalette::Window, QColor(53,53,53));
@@ -26,5 +37,7 @@ int main(int argc, char *argv[])
     darkPalette.setColor(QPalette::HighlightedText, Qt::black);
 
     a.setPalette(darkPalette);
+    StartupProfiler::mark("palette applied");
+    QTimer::singleShot(0, []() { StartupProfiler::mark("event loop running"); });
     return a.exec();
 }
@@ -1,335 +1,266 @@
 #include "mainwindow.h"
 #include "./ui_mainwindow.h"
 #include "taskdialog.h"
+#include "taskcolumnmodel.h"
+#include "taskstore.h"
+#include "taskhistory.h"
+#include "taskdependencytracker.h"
+#include "taskscheduler.h"
+#include "richtextdelegate.h"
+#include "databaseworker.h"
+#include "tasksnapshot.h"
+#include "startupprofiler.h"
 #include <QDebug>
 #include <QMessageBox>
-#include <QSqlQuery>
-#include <QSqlError>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QCheckBox>
-#include <QRegularExpression>
 #include <QFileDialog>
+#include <QAction>
+#include <QListView>
+#include <QDate>
+#include <QThread>
+#include <QTimer>
+#include <QProgressDialog>
+#include <memory>
+
+static const char *kDatabasePath = "./todo.db";
+static const char *kSnapshotPath = "./todo.snapshot";
+
+// Set TODO_NO_SNAPSHOT to always start from a full SQLite load.
+static bool snapshotsEnabled()
+{
+    return !qEnvironmentVariableIsSet("TODO_NO_SNAPSHOT");
+}
 
-int findTaskIndexById(const QVector<Task>& tasks, int id) {
-    for (int i = 0; i < tasks.size(); ++i) {
-        if (tasks[i].id == id)
-            return i;
-    }
-    return -1;
+// Set TODO_NO_HISTORY_JOURNAL to keep undo history for this session only.
+static bool historyJournalEnabled()
+{
+    return !qEnvironmentVariableIsSet("TODO_NO_HISTORY_JOURNAL");
 }
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
+    , searchIndexReady(false)
+    , searchGeneration(0)
+    , searchResultsPending(false)
+    , progressDialog(nullptr)
+    , historyRestored(false)
 {
     ui->setupUi(this);
     ui->stackedWidget->setCurrentWidget(ui->page);
+
+    dbThread = new QThread(this);
+    dbWorker = new DatabaseWorker;
+    dbWorker->moveToThread(dbThread);
+    connect(dbThread, &QThread::finished, dbWorker, &QObject::deleteLater);
+    connect(dbWorker, &DatabaseWorker::opened, this, &MainWindow::onDatabaseOpened);
+    connect(dbWorker, &DatabaseWorker::openTasksDueLoaded, this, &MainWindow::onOpenTasksDueLoaded);
+    connect(dbWorker, &DatabaseWorker::searchResults, this, &MainWindow::onSearchResults);
+    connect(dbWorker, &DatabaseWorker::requestFailed, this, &MainWindow::onDatabaseError);
+    connect(dbWorker, &DatabaseWorker::importProgress, this, &MainWindow::onImportProgress);
+    connect(dbWorker, &DatabaseWorker::importFinished, this, &MainWindow::onImportFinished);
+    connect(dbWorker, &DatabaseWorker::exportProgress, this, &MainWindow::onExportProgress);
+    connect(dbWorker, &DatabaseWorker::exportFinished, this, &MainWindow::onExportFinished);
+    connect(dbWorker, &DatabaseWorker::historyLoaded, this, &MainWindow::onHistoryLoaded);
+    dbThread->start();
+
+    store = new TaskStore(dbWorker, this);
+    history.reset(new TaskHistory(store));
+    // Connected ahead of updateRecommendations so edits reach them first.
+    dependencyTracker = new TaskDependencyTracker(this);
+    dependencyTracker->setStore(store);
+    scheduler = new TaskScheduler(this);
+    scheduler->setStore(store);
+    connect(store, &TaskStore::tasksReset, this, &MainWindow::updateRecommendations);
+    connect(store, &TaskStore::taskAdded, this, &MainWindow::updateRecommendations);
+    connect(store, &TaskStore::taskUpdated, this, &MainWindow::updateRecommendations);
+    connect(store, &TaskStore::taskRemoved, this, &MainWindow::updateRecommendations);
+    connect(store, &TaskStore::tasksChanged, this, &MainWindow::updateRecommendations);
+    connect(store, &TaskStore::dependenciesChanged, this, &MainWindow::updateRecommendations);
+    pendingModel = new TaskColumnModel(TaskStatus::Pending, this);
+    inProgressModel = new TaskColumnModel(TaskStatus::InProgress, this);
+    completeModel = new TaskColumnModel(TaskStatus::Complete, this);
+    pendingModel->setStore(store);
+    inProgressModel->setStore(store);
+    completeModel->setStore(store);
+    ui->PendingList->setModel(pendingModel);
+    ui->InProgressList->setModel(inProgressModel);
+    ui->CompleteList->setModel(completeModel);
+    addBulkActions(ui->PendingList);
+    addBulkActions(ui->InProgressList);
+    addBulkActions(ui->CompleteList);
+    ui->SearchListWidget->setItemDelegate(new RichTextDelegate(ui->SearchListWidget));
+
+    searchTimer = new QTimer(this);
+    searchTimer->setSingleShot(true);
+    searchTimer->setInterval(150);
+    connect(searchTimer, &QTimer::timeout, this, &MainWindow::runSearch);
 }
 
 MainWindow::~MainWindow()
 {
+    dbWorker->cancelSearches(++searchGeneration);
+    dbWorker->cancelImport();
+    dbWorker->cancelExport();
+    // Not until the saved history has been read back, or it would be lost.
+    if (historyRestored)
+        dbWorker->saveHistory(history->undoActions(), history->redoActions());
+    if (snapshotsEnabled())
+        dbWorker->writeSnapshot(kSnapshotPath);
+    dbThread->quit();
+    dbThread->wait();
     delete ui;
 }
 
 void MainWindow::createDatabase()
 {
-    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE");
-    db.setDatabaseName("./todo.db");
-    if (!db.open()) {
-        QMessageBox::critical(this, "Database Error", "Unable to open the database.");
-        return;
-    }
-    QSqlQuery query(db);
-    query.exec(
-        "CREATE TABLE IF NOT EXISTS tasks ("
-        "id INTEGER PRIMARY KEY AUTOINCREMENT,"
-        "title TEXT NOT NULL,"
-        "description TEXT,"
-        "due_date TEXT,"
-        "sub_tasks TEXT,"
-        "priority INTEGER DEFAULT 0,"
-        "completed INTEGER DEFAULT 0,"
-        "status TEXT DEFAULT 'pending',"
-        "UNIQUE(id)"
-        ")"
-        );
-    db.close();
+    StartupProfiler::mark("database open requested");
+    dbWorker->requestOpen(kDatabasePath);
 }
 
-void MainWindow::refreshAllTasksFromDb()
+void MainWindow::onDatabaseOpened(bool ok, bool searchReady, const QString &error)
 {
-    allTasks.clear();
-    QSqlDatabase db = QSqlDatabase::database();
-    if (!db.isOpen()) db.open();
-    QSqlQuery query("SELECT * FROM tasks", db);
-    while(query.next()) {
-        Task t;
-        t.id = query.value("id").toInt();
-        t.title = query.value("title").toString();
-        t.description = query.value("description").toString();
-        t.dueDate = query.value("due_date").toString();
-        t.subTasks = query.value("sub_tasks").toString();
-        t.priority = query.value("priority").toInt();
-        t.status = query.value("status").toString();
-        allTasks.push_back(t);
+    StartupProfiler::mark("database opened");
+    searchIndexReady = searchReady;
+    if (!ok) {
+        QMessageBox::critical(this, "Database Error", "Unable to open the database.\n" + error);
+        return;
     }
+    if (historyJournalEnabled())
+        dbWorker->requestLoadHistory();
 }
 
-void MainWindow::pushTaskToUndoStack(int id)
+void MainWindow::onHistoryLoaded(const QVector<TaskAction> &undo, const QVector<TaskAction> &redo)
 {
-    int idx = findTaskIndexById(allTasks, id);
-    if(idx != -1) {
-        undoStack.push_back({allTasks[idx], TaskActionType::Update});
-    }
-    redoStack.clear();
+    // Edits made before the saved history arrived win over it.
+    history->restore(undo, redo);
+    historyRestored = true;
 }
 
-void MainWindow::pushDeletedTaskToUndoStack(int id)
+void MainWindow::onDatabaseError(const QString &error, bool wasWrite)
 {
-    int idx = findTaskIndexById(allTasks, id);
-    if(idx != -1) {
-        undoStack.push_back({allTasks[idx], TaskActionType::Delete});
+    // A failed read keeps the board as it is; reloading again would only
+    // fail the same way.
+    if (!wasWrite) {
+        QMessageBox::warning(this, "Database Error", "Could not read tasks from the database.\n" + error);
+        return;
     }
-    redoStack.clear();
+    QMessageBox::warning(this, "Database Error", "A database write failed, reloading tasks.\n" + error);
+    refreshAllTasksFromDb();
 }
 
-void MainWindow::pushTaskToRedoStack(int id, TaskActionType type)
+void MainWindow::refreshAllTasksFromDb()
 {
-    int idx = findTaskIndexById(allTasks, id);
-    if(idx != -1) {
-        redoStack.push_back({allTasks[idx], type});
-    }
+    store->load();
 }
 
 void MainWindow::displayTasks()
 {
-    refreshAllTasksFromDb();
-    ui->PendingList->clear();
-    ui->InProgressList->clear();
-    ui->CompleteList->clear();
-    for (const Task& t : allTasks) {
-        QString item = "(" + QString::number(t.id) + ") " + t.title + " - Due: " + t.dueDate;
-        if (t.status == "pending") {
-            ui->PendingList->addItem(item);
-        } else if (t.status == "in progress") {
-            ui->InProgressList->addItem(item);
-        } else if (t.status == "complete") {
-            ui->CompleteList->addItem(item);
-        }
-    }
+    setBoardOrder(TaskOrder::ById);
 
     updateRecommendations();
 }
 
-void MainWindow::displayTasksByDeadline()
+void MainWindow::setBoardOrder(TaskOrder order)
 {
-    QSqlDatabase db = QSqlDatabase::database();
-    if (!db.isOpen()) db.open();
-
-    allTasks.clear();
-    QSqlQuery query("SELECT * FROM tasks ORDER BY due_date", db);
-
-    TaskQueue queue;
-
-    while(query.next()) {
-        Task t;
-        t.id = query.value("id").toInt();
-        t.title = query.value("title").toString();
-        t.description = query.value("description").toString();
-        t.dueDate = query.value("due_date").toString();
-        t.subTasks = query.value("sub_tasks").toString();
-        t.priority = query.value("priority").toInt();
-        t.status = query.value("status").toString();
-
-        queue.enqueue(t);
-    }
+    // Every order is already maintained in memory; this only relays out.
+    for (TaskColumnModel *column : {pendingModel, inProgressModel, completeModel})
+        column->setOrder(order);
+}
 
-    ui->PendingList->clear();
-    ui->InProgressList->clear();
-    ui->CompleteList->clear();
-
-    while (!queue.isEmpty()) {
-        Task t = queue.dequeue();
-        QString item = "(" + QString::number(t.id) + ") " + t.title + " - Due: " + t.dueDate;
-        if (t.status == "pending") {
-            ui->PendingList->addItem(item);
-        } else if (t.status == "in progress") {
-            ui->InProgressList->addItem(item);
-        } else if (t.status == "complete") {
-            ui->CompleteList->addItem(item);
-        }
-    }
+void MainWindow::displayTasksByDeadline()
+{
+    setBoardOrder(TaskOrder::ByDueDate);
 }
 
 void MainWindow::displayTasksByPriority()
 {
-    QSqlDatabase db = QSqlDatabase::database();
-    if (!db.isOpen()) db.open();
-    allTasks.clear();
-    QSqlQuery query("SELECT * FROM tasks ORDER BY priority DESC", db);
-    while(query.next()) {
-        Task t;
-        t.id = query.value("id").toInt();
-        t.title = query.value("title").toString();
-        t.description = query.value("description").toString();
-        t.dueDate = query.value("due_date").toString();
-        t.subTasks = query.value("sub_tasks").toString();
-        t.priority = query.value("priority").toInt();
-        t.status = query.value("status").toString();
-        allTasks.push_back(t);
-    }
-    ui->PendingList->clear();
-    ui->InProgressList->clear();
-    ui->CompleteList->clear();
-    for (const Task& t : allTasks) {
-        QString item = "(" + QString::number(t.id) + ") " + t.title + " - Due: " + t.dueDate;
-        if (t.status == "pending") {
-            ui->PendingList->addItem(item);
-        } else if (t.status == "in progress") {
-            ui->InProgressList->addItem(item);
-        } else if (t.status == "complete") {
-            ui->CompleteList->addItem(item);
-        }
-    }
+    setBoardOrder(TaskOrder::ByPriority);
 }
 
 void MainWindow::displayNotifications()
 {
-    QSqlDatabase db = QSqlDatabase::database();
-    if (!db.isOpen()) db.open();
-
-    QSqlQuery query(db);
-    query.prepare("SELECT * FROM tasks WHERE status IN ('pending', 'in progress')");
-    query.exec();
+    dbWorker->requestOpenTasksDueBy(QDate::currentDate().addDays(1));
+    ui->stackedWidget->setCurrentWidget(ui->page_4);
+}
 
+void MainWindow::onOpenTasksDueLoaded(const QVector<Task> &tasks)
+{
     ui->NotificationlistWidget->clear();
 
-    TaskNode* head = nullptr;
-    TaskNode* tail = nullptr;
-    QHash<int, TaskNode*> taskTable;
-
-    QDate today = QDate::currentDate();
-    QDate tomorrow = today.addDays(1);
+    const qint64 today = QDate::currentDate().toJulianDay();
+    const qint64 tomorrow = today + 1;
 
-    while (query.next()) {
-        Task t;
-        t.id = query.value("id").toInt();
-        t.title = query.value("title").toString();
-        t.description = query.value("description").toString();
-        t.dueDate = query.value("due_date").toString();
-        t.subTasks = query.value("sub_tasks").toString();
-        t.priority = query.value("priority").toInt();
-        t.status = query.value("status").toString();
-
-        QDate taskDate = QDate::fromString(t.dueDate, "yyyy-MM-dd");
+    for (const Task &t : tasks) {
         QString dueText;
 
-        if (taskDate < today) {
+        if (t.dueDay < today) {
             dueText = "Overdue!";
-        } else if (taskDate == today) {
+        } else if (t.dueDay == today) {
             dueText = "Due Today! Stay focused.";
-        } else if (taskDate == tomorrow) {
+        } else if (t.dueDay == tomorrow) {
             dueText = "Due Tomorrow! Be prepared.";
         } else {
             continue;
         }
 
-        TaskNode* newNode = new TaskNode(t);
-        if (!head) {
-            head = tail = newNode;
-        } else {
-            tail->next = newNode;
-            tail = newNode;
-        }
-        taskTable.insert(t.id, newNode);
-
         QString itemText = QString("(%1) %2 - %3")
                                .arg(t.id)
                                .arg(t.title)
                                .arg(dueText);
-        ui->NotificationlistWidget->addItem(itemText);
-    }
-
-    db.close();
-    ui->stackedWidget->setCurrentWidget(ui->page_4);
-
-    TaskNode* current = head;
-    while (current) {
-        TaskNode* temp = current;
-        current = current->next;
-        delete temp;
-    }
-}
-
-void MainWindow::buildTaskDependencyGraph() {
-    dependencyGraph.clear();
-    QMap<QString, int> titleToId;
-    for (const Task& t : allTasks)
-        titleToId[t.title.toLower()] = t.id;
-
-    for (const Task& t : allTasks) {
-        QSet<int> deps;
-        QString desc = t.description.toLower();
-        for (const QString& otherTitle : titleToId.keys()) {
-            if (t.id == titleToId[otherTitle])
-                continue;
-            if (desc.contains(otherTitle) || t.title.toLower().contains(otherTitle)) {
-                deps.insert(titleToId[otherTitle]);
-            }
-        }
-        dependencyGraph[t.id] = deps;
+        QListWidgetItem *item = new QListWidgetItem(itemText, ui->NotificationlistWidget);
+        item->setData(Qt::UserRole, t.id);
     }
 }
 
 QVector<Task> MainWindow::getGraphRecommendedTasks(int maxRecs) {
-    QSet<int> completed;
-    for (const Task& t : allTasks) {
-        if (t.status == "complete")
-            completed.insert(t.id);
-    }
-    QVector<Task> candidates;
-    for (const Task& t : allTasks) {
-        if (t.status == "complete") continue;
-        bool allDepsDone = true;
-        for (int dep : dependencyGraph.value(t.id)) {
-            if (!completed.contains(dep)) {
-                allDepsDone = false;
-                break;
-            }
-        }
-        if (allDepsDone)
-            candidates.push_back(t);
-    }
-    std::sort(candidates.begin(), candidates.end(), [](const Task& a, const Task& b) {
-        if (a.priority != b.priority)
-            return a.priority > b.priority;
-        QDate da = QDate::fromString(a.dueDate, "yyyy-MM-dd");
-        QDate db = QDate::fromString(b.dueDate, "yyyy-MM-dd");
-        if (da.isValid() && db.isValid())
-            return da < db;
-        if (da.isValid()) return true;
-        if (db.isValid()) return false;
-        return a.id < b.id;
-    });
-    if (candidates.size() > maxRecs)
-        candidates.resize(maxRecs);
-    return candidates;
+    return scheduler->recommend(maxRecs);
 }
 
 void MainWindow::updateRecommendations() {
     QVector<Task> recs = getGraphRecommendedTasks(5);
     ui->taskRecommendationListWidget->clear();
     for (const Task& t : recs) {
-        QString rec = QString("%1 (Priority: %2, Due: %3)").arg(t.title).arg(t.priority).arg(t.dueDate);
+        QString rec = QString("%1 (Priority: %2, Due: %3)").arg(t.title).arg(t.priority).arg(dueDayText(t.dueDay));
         ui->taskRecommendationListWidget->addItem(rec);
     }
 }
 
 
+void MainWindow::traceFirstBoardPaint()
+{
+    auto connection = std::make_shared<QMetaObject::Connection>();
+    *connection = connect(store, &TaskStore::tasksReset, this, [this, connection]() {
+        disconnect(*connection);
+        StartupProfiler::mark("tasks in store");
+        StartupProfiler::markOnNextPaint(ui->PendingList->viewport(), "first board painted");
+    });
+}
+
+bool MainWindow::loadSnapshot()
+{
+    if (!snapshotsEnabled())
+        return false;
+    TaskSnapshot snapshot;
+    if (!snapshot.load(kSnapshotPath))
+        return false;
+    StartupProfiler::mark("snapshot decoded");
+    store->reset(snapshot.tasks());
+    store->loadDependencies();
+    dbWorker->requestLoadIfChanged(snapshot.revision());
+    return true;
+}
+
 void MainWindow::on_StartButton_clicked()
 {
+    // The snapshot paints the board straight away; the worker then checks
+    // it against the database and reloads only if something changed.
+    traceFirstBoardPaint();
     createDatabase();
+    if (!loadSnapshot())
+        refreshAllTasksFromDb();
     displayTasks();
     ui->stackedWidget->setCurrentWidget(ui->page_2);
 }
@@ -345,19 +276,17 @@ void MainWindow::on_AddButton_clicked()
         QMessageBox::warning(this, "Input Error", "Please fill in all fields correctly.\nPriority must be between 0 and 5.");
         return;
     }
-    QSqlDatabase db = QSqlDatabase::database();
-    if (!db.isOpen()) db.open();
-    QSqlQuery query(db);
-    query.prepare("INSERT INTO tasks (title, description, due_date, sub_tasks, priority) VALUES (?, ?, ?, ?, ?)");
-    query.addBindValue(taskTitle);
-    query.addBindValue(description);
-    query.addBindValue(dueDate);
-    query.addBindValue(subTasks);
-    query.addBindValue(priority);
-    query.exec();
-    db.close();
-    refreshAllTasksFromDb();
-    displayTasks();
+    Task t;
+    if (!parseDueDay(dueDate, &t.dueDay)) {
+        QMessageBox::warning(this, "Input Error", "Due date must be a valid date in yyyy-mm-dd format.");
+        return;
+    }
+    t.title = taskTitle;
+    t.description = description;
+    t.subTasks = splitSubTasks(subTasks);
+    t.priority = priority;
+    t.status = TaskStatus::Pending;
+    store->addTask(t);
     ui->TaskLineEdit->clear();
     ui->DescriptionLineEdit->clear();
     ui->DueDateLineEdit->clear();
@@ -367,6 +296,7 @@ void MainWindow::on_AddButton_clicked()
 
 void MainWindow::on_ReloadButton_clicked()
 {
+    refreshAllTasksFromDb();
     displayTasks();
 }
 
@@ -380,280 +310,163 @@ void MainWindow::on_SortByPriorityButton_clicked()
     displayTasksByPriority();
 }
 
-Task getTaskById(int id) {
-    QSqlDatabase db = QSqlDatabase::database();
-    if (!db.isOpen()) db.open();
-    QSqlQuery q(db);
-    q.prepare("SELECT * FROM tasks WHERE id = ?");
-    q.addBindValue(id);
-    q.exec();
-    if (q.next()) {
-        Task t;
-        t.id = q.value("id").toInt();
-        t.title = q.value("title").toString();
-        t.description = q.value("description").toString();
-        t.dueDate = q.value("due_date").toString();
-        t.subTasks = q.value("sub_tasks").toString();
-        t.priority = q.value("priority").toInt();
-        t.status = q.value("status").toString();
-        return t;
-    }
-    return Task{};
-}
-
-void MainWindow::on_PendingList_doubleClicked(const QModelIndex &index)
+void MainWindow::openTaskDialog(const QModelIndex &index)
 {
-    QListWidgetItem* item = ui->PendingList->item(index.row());
-    if (!item) return;
-    QString taskDetails = item->text();
-    QStringList details = taskDetails.split(" - Due: ");
-    if (details.size() < 2) {
+    if (!index.isValid()) return;
+    int id = index.data(Qt::UserRole).toInt();
+    const Task *found = store->taskById(id);
+    if (!found) {
         QMessageBox::warning(this, "Selection Error", "Please select a valid task.");
         return;
     }
-    QString leftPart = details[0];
-    QRegularExpression re("^\\((\\d+)\\)\\s*(.+)$");
-    QRegularExpressionMatch match = re.match(leftPart);
-    if (!match.hasMatch()) {
-        QMessageBox::warning(this, "Parsing Error", "Could not extract task ID and title.");
-        return;
-    }
-    int id = match.captured(1).toInt();
-    Task t = getTaskById(id);
-    QStringList subTasksArray = t.subTasks.split(",", Qt::SkipEmptyParts);
-    TaskDialog dlg(t.title, t.description, t.dueDate, t.priority, subTasksArray, t.status, this);
+    Task t = *found;
+    TaskDialog dlg(t.title, t.description, dueDayText(t.dueDay), t.priority, t.subTasks, t.status, this);
     dlg.setWindowTitle("Task Options");
+
+    // Title mentions are only offered as suggestions; the stored edges are
+    // what recommendations follow.
+    const QVector<int> dependsOn = store->dependencies().dependenciesOf(id);
+    QVector<QPair<int, QString>> current, suggested;
+    for (int dep : dependsOn) {
+        if (const Task *task = store->taskById(dep))
+            current.append(qMakePair(dep, task->title));
+    }
+    for (int dep : dependencyTracker->graph().dependenciesOf(id)) {
+        if (suggested.size() == 10)
+            break;
+        const Task *task = store->taskById(dep);
+        if (task && !dependsOn.contains(dep))
+            suggested.append(qMakePair(dep, task->title));
+    }
+    dlg.setDependencies(current, suggested);
+
     dlg.exec();
-    QSqlDatabase db = QSqlDatabase::database();
-    if (!db.isOpen()) db.open();
-    QString newStatus;
+    TaskStatus newStatus = t.status;
     switch (dlg.result()) {
+    case TaskActionDialogResult::SetToPending:
+        newStatus = TaskStatus::Pending;
+        break;
     case TaskActionDialogResult::SetToInProgress:
-        pushTaskToUndoStack(id);
-        newStatus = "in progress";
+        newStatus = TaskStatus::InProgress;
         break;
     case TaskActionDialogResult::SetToComplete:
-        pushTaskToUndoStack(id);
-        newStatus = "complete";
+        newStatus = TaskStatus::Complete;
         break;
-    case TaskActionDialogResult::Delete: {
-        pushDeletedTaskToUndoStack(id);
-        QSqlQuery deleteQuery(db);
-        deleteQuery.prepare("DELETE FROM tasks WHERE id = ?");
-        deleteQuery.addBindValue(id);
-        deleteQuery.exec();
-        refreshAllTasksFromDb();
-        displayTasks();
+    case TaskActionDialogResult::SaveDependencies:
+        applyDependencies(id, dlg.selectedDependencies());
+        return;
+    case TaskActionDialogResult::Delete:
+        history->removeTask(id);
         QMessageBox::information(this, "Task Deleted", QString("The task '%1' has been deleted.").arg(t.title));
         return;
-    }
     default:
         return;
     }
-    QSqlQuery updateQuery(db);
-    updateQuery.prepare("UPDATE tasks SET status = ? WHERE id = ?");
-    updateQuery.addBindValue(newStatus);
-    updateQuery.addBindValue(id);
-    updateQuery.exec();
-    refreshAllTasksFromDb();
-    displayTasks();
-    QMessageBox::information(this, "Task Updated", QString("The task '%1' has been updated to '%2'.").arg(t.title, newStatus));
+    applyDependencies(id, dlg.selectedDependencies());
+    history->setStatus(id, newStatus);
+    QMessageBox::information(this, "Task Updated", QString("The task '%1' has been updated to '%2'.").arg(t.title, taskStatusText(newStatus)));
 }
 
-void MainWindow::on_InProgressList_doubleClicked(const QModelIndex &index)
+// Right-click actions on a board list that act on every selected task at
+// once: one store edit, one database transaction and one undo step.
+void MainWindow::addBulkActions(QListView *list)
 {
-    QListWidgetItem* item = ui->InProgressList->item(index.row());
-    if (!item) return;
-    QString taskDetails = item->text();
-    QStringList details = taskDetails.split(" - Due: ");
-    if (details.size() < 2) {
-        QMessageBox::warning(this, "Selection Error", "Please select a valid task.");
+    list->setContextMenuPolicy(Qt::ActionsContextMenu);
+    const QPair<QString, TaskStatus> moves[] = {
+        {"Move to Pending", TaskStatus::Pending},
+        {"Move to In Progress", TaskStatus::InProgress},
+        {"Move to Complete", TaskStatus::Complete},
+    };
+    for (const auto &move : moves) {
+        QAction *action = new QAction(move.first, list);
+        const TaskStatus status = move.second;
+        connect(action, &QAction::triggered, this, [this, list, status]() { moveSelectedTasks(list, status); });
+        list->addAction(action);
+    }
+    QAction *remove = new QAction("Delete", list);
+    remove->setShortcut(QKeySequence::Delete);
+    remove->setShortcutContext(Qt::WidgetShortcut);
+    connect(remove, &QAction::triggered, this, [this, list]() { deleteSelectedTasks(list); });
+    list->addAction(remove);
+}
+
+QVector<int> MainWindow::selectedTaskIds(QListView *list) const
+{
+    QVector<int> ids;
+    for (const QModelIndex &index : list->selectionModel()->selectedIndexes())
+        ids.push_back(index.data(TaskColumnModel::TaskIdRole).toInt());
+    return ids;
+}
+
+void MainWindow::moveSelectedTasks(QListView *list, TaskStatus status)
+{
+    const QVector<int> ids = selectedTaskIds(list);
+    if (!ids.isEmpty())
+        history->setStatuses(ids, status);
+}
+
+void MainWindow::deleteSelectedTasks(QListView *list)
+{
+    const QVector<int> ids = selectedTaskIds(list);
+    if (ids.isEmpty())
         return;
-    }
-    QString leftPart = details[0];
-    QRegularExpression re("^\\((\\d+)\\)\\s*(.+)$");
-    QRegularExpressionMatch match = re.match(leftPart);
-    if (!match.hasMatch()) {
-        QMessageBox::warning(this, "Parsing Error", "Could not extract task ID and title.");
+    const QString question = ids.size() == 1 ? QString("Delete the selected task?")
+                                             : QString("Delete the %1 selected tasks?").arg(ids.size());
+    if (QMessageBox::question(this, "Delete Tasks", question) != QMessageBox::Yes)
         return;
+    history->removeTasks(ids);
+}
+
+void MainWindow::applyDependencies(int id, const QVector<int> &dependsOn)
+{
+    const QVector<int> current = store->dependencies().dependenciesOf(id);
+    for (int dep : current) {
+        if (!dependsOn.contains(dep))
+            store->removeDependency(id, dep);
     }
-    int id = match.captured(1).toInt();
-    Task t = getTaskById(id);
-    QStringList subTasksArray = t.subTasks.split(",", Qt::SkipEmptyParts);
-    TaskDialog dlg(t.title, t.description, t.dueDate, t.priority, subTasksArray, t.status, this);
-    dlg.setWindowTitle("Task Options");
-    dlg.exec();
-    QSqlDatabase db = QSqlDatabase::database();
-    if (!db.isOpen()) db.open();
-    QString newStatus;
-    switch (dlg.result()) {
-    case TaskActionDialogResult::SetToPending:
-        pushTaskToUndoStack(id);
-        newStatus = "pending";
-        break;
-    case TaskActionDialogResult::SetToComplete:
-        pushTaskToUndoStack(id);
-        newStatus = "complete";
-        break;
-    case TaskActionDialogResult::Delete: {
-        pushDeletedTaskToUndoStack(id);
-        QSqlQuery deleteQuery(db);
-        deleteQuery.prepare("DELETE FROM tasks WHERE id = ?");
-        deleteQuery.addBindValue(id);
-        deleteQuery.exec();
-        refreshAllTasksFromDb();
-        displayTasks();
-        QMessageBox::information(this, "Task Deleted", QString("The task '%1' has been deleted.").arg(t.title));
-        return;
+    QStringList refused;
+    for (int dep : dependsOn) {
+        if (!current.contains(dep) && !store->addDependency(id, dep))
+            refused << QString::number(dep);
     }
-    default:
-        return;
+    if (!refused.isEmpty()) {
+        QMessageBox::warning(this, "Dependency Error",
+                             QString("Could not depend on task %1: no such task, or it would create a cycle.")
+                                 .arg(refused.join(", ")));
     }
-    QSqlQuery updateQuery(db);
-    updateQuery.prepare("UPDATE tasks SET status = ? WHERE id = ?");
-    updateQuery.addBindValue(newStatus);
-    updateQuery.addBindValue(id);
-    updateQuery.exec();
-    refreshAllTasksFromDb();
-    displayTasks();
-    QMessageBox::information(this, "Task Updated", QString("The task '%1' has been updated to '%2'.").arg(t.title, newStatus));
+}
+
+void MainWindow::on_PendingList_doubleClicked(const QModelIndex &index)
+{
+    openTaskDialog(index);
+}
+
+void MainWindow::on_InProgressList_doubleClicked(const QModelIndex &index)
+{
+    openTaskDialog(index);
 }
 
 void MainWindow::on_CompleteList_doubleClicked(const QModelIndex &index)
 {
-    QListWidgetItem* item = ui->CompleteList->item(index.row());
-    if (!item) return;
-    QString taskDetails = item->text();
-    QStringList details = taskDetails.split(" - Due: ");
-    if (details.size() < 2) {
-        QMessageBox::warning(this, "Selection Error", "Please select a valid task.");
-        return;
-    }
-    QString leftPart = details[0];
-    QRegularExpression re("^\\((\\d+)\\)\\s*(.+)$");
-    QRegularExpressionMatch match = re.match(leftPart);
-    if (!match.hasMatch()) {
-        QMessageBox::warning(this, "Parsing Error", "Could not extract task ID and title.");
-        return;
-    }
-    int id = match.captured(1).toInt();
-    Task t = getTaskById(id);
-    QStringList subTasksArray = t.subTasks.split(",", Qt::SkipEmptyParts);
-    TaskDialog dlg(t.title, t.description, t.dueDate, t.priority, subTasksArray, t.status, this);
-    dlg.setWindowTitle("Task Options");
-    dlg.exec();
-    QSqlDatabase db = QSqlDatabase::database();
-    if (!db.isOpen()) db.open();
-    QString newStatus;
-    switch (dlg.result()) {
-    case TaskActionDialogResult::SetToPending:
-        pushTaskToUndoStack(id);
-        newStatus = "pending";
-        break;
-    case TaskActionDialogResult::SetToInProgress:
-        pushTaskToUndoStack(id);
-        newStatus = "in progress";
-        break;
-    case TaskActionDialogResult::Delete: {
-        pushDeletedTaskToUndoStack(id);
-        QSqlQuery deleteQuery(db);
-        deleteQuery.prepare("DELETE FROM tasks WHERE id = ?");
-        deleteQuery.addBindValue(id);
-        deleteQuery.exec();
-        refreshAllTasksFromDb();
-        displayTasks();
-        QMessageBox::information(this, "Task Deleted", QString("The task '%1' has been deleted.").arg(t.title));
-        return;
-    }
-    default:
-        return;
-    }
-    QSqlQuery updateQuery(db);
-    updateQuery.prepare("UPDATE tasks SET status = ? WHERE id = ?");
-    updateQuery.addBindValue(newStatus);
-    updateQuery.addBindValue(id);
-    updateQuery.exec();
-    refreshAllTasksFromDb();
-    displayTasks();
-    QMessageBox::information(this, "Task Updated", QString("The task '%1' has been updated to '%2'.").arg(t.title, newStatus));
+    openTaskDialog(index);
 }
 
 
 void MainWindow::on_UndoButton_clicked()
 {
-    if (undoStack.isEmpty()) {
+    if (!history->undo()) {
         QMessageBox::information(this, "Undo", "Nothing to undo.");
         return;
     }
-    TaskAction last = undoStack.takeLast();
-    QSqlDatabase db = QSqlDatabase::database();
-    if (!db.isOpen()) db.open();
-    if (last.type == TaskActionType::Delete) {
-        QSqlQuery q(db);
-        q.prepare("INSERT INTO tasks (id, title, description, due_date, sub_tasks, priority, status) VALUES (?, ?, ?, ?, ?, ?, ?)");
-        q.addBindValue(last.task.id);
-        q.addBindValue(last.task.title);
-        q.addBindValue(last.task.description);
-        q.addBindValue(last.task.dueDate);
-        q.addBindValue(last.task.subTasks);
-        q.addBindValue(last.task.priority);
-        q.addBindValue(last.task.status);
-        q.exec();
-        redoStack.push_back({last.task, TaskActionType::Delete});
-    } else if (last.type == TaskActionType::Update) {
-        int idx = findTaskIndexById(allTasks, last.task.id);
-        if (idx != -1) {
-            QSqlQuery q(db);
-            q.prepare("UPDATE tasks SET title=?, description=?, due_date=?, sub_tasks=?, priority=?, status=? WHERE id=?");
-            q.addBindValue(last.task.title);
-            q.addBindValue(last.task.description);
-            q.addBindValue(last.task.dueDate);
-            q.addBindValue(last.task.subTasks);
-            q.addBindValue(last.task.priority);
-            q.addBindValue(last.task.status);
-            q.addBindValue(last.task.id);
-            q.exec();
-            pushTaskToRedoStack(last.task.id, TaskActionType::Update);
-        }
-    }
-    refreshAllTasksFromDb();
-    displayTasks();
     QMessageBox::information(this, "Undo", "Undo performed.");
 }
 
 void MainWindow::on_RedoButton_clicked()
 {
-    if (redoStack.isEmpty()) {
+    if (!history->redo()) {
         QMessageBox::information(this, "Redo", "Nothing to redo.");
         return;
     }
-    TaskAction redoAction = redoStack.takeLast();
-    QSqlDatabase db = QSqlDatabase::database();
-    if (!db.isOpen()) db.open();
-    if (redoAction.type == TaskActionType::Delete) {
-        QSqlQuery q(db);
-        q.prepare("DELETE FROM tasks WHERE id=?");
-        q.addBindValue(redoAction.task.id);
-        q.exec();
-        undoStack.push_back({redoAction.task, TaskActionType::Delete});
-    } else if (redoAction.type == TaskActionType::Update) {
-        int idx = findTaskIndexById(allTasks, redoAction.task.id);
-        if (idx != -1) {
-            QSqlQuery q(db);
-            q.prepare("UPDATE tasks SET title=?, description=?, due_date=?, sub_tasks=?, priority=?, status=? WHERE id=?");
-            q.addBindValue(redoAction.task.title);
-            q.addBindValue(redoAction.task.description);
-            q.addBindValue(redoAction.task.dueDate);
-            q.addBindValue(redoAction.task.subTasks);
-            q.addBindValue(redoAction.task.priority);
-            q.addBindValue(redoAction.task.status);
-            q.addBindValue(redoAction.task.id);
-            q.exec();
-            pushTaskToUndoStack(redoAction.task.id);
-        }
-    }
-    refreshAllTasksFromDb();
-    displayTasks();
     QMessageBox::information(this, "Redo", "Redo performed.");
 }
 
@@ -665,36 +478,47 @@ void MainWindow::on_SearchPageButton_clicked()
 
 void MainWindow::on_SearchButton_clicked()
 {
-    QSqlDatabase db = QSqlDatabase::database();
-    if (!db.isOpen()) db.open();
-    QString searchText = ui->SearchLineEdit->text();
-    if (searchText.isEmpty()) {
+    if (ui->SearchLineEdit->text().trimmed().isEmpty()) {
         QMessageBox::warning(this, "Search Error", "Please enter a search term.");
         return;
     }
-    QSqlQuery query(db);
-    query.prepare("SELECT * FROM tasks WHERE title LIKE ? OR description LIKE ?");
-    query.addBindValue("%" + searchText + "%");
-    query.addBindValue("%" + searchText + "%");
-    query.exec();
-    ui->SearchListWidget->clear();
-    while(query.next()) {
-        Task t;
-        t.id = query.value("id").toInt();
-        t.title = query.value("title").toString();
-        t.description = query.value("description").toString();
-        t.dueDate = query.value("due_date").toString();
-        t.subTasks = query.value("sub_tasks").toString();
-        t.priority = query.value("priority").toInt();
-        t.status = query.value("status").toString();
-        QString itemText = QString("(%1) %2 - Due: %3").arg(t.id).arg(t.title).arg(t.dueDate);
-        ui->SearchListWidget->addItem(itemText);
+    searchTimer->stop();
+    runSearch();
+}
+
+void MainWindow::on_SearchLineEdit_textChanged(const QString &)
+{
+    searchTimer->start();
+}
+
+void MainWindow::runSearch()
+{
+    QString searchText = ui->SearchLineEdit->text().trimmed();
+    quint64 generation = ++searchGeneration;
+    dbWorker->cancelSearches(generation);
+    searchResultsPending = true;
+    if (searchText.isEmpty()) {
+        ui->SearchListWidget->clear();
+        return;
     }
-    if (ui->SearchListWidget->count() == 0) {
+    dbWorker->requestSearch(generation, searchText);
+}
+
+void MainWindow::onSearchResults(quint64 generation, const QVector<SearchHit> &hits, bool done)
+{
+    if (generation != searchGeneration)
+        return;
+    if (searchResultsPending) {
+        ui->SearchListWidget->clear();
+        searchResultsPending = false;
+    }
+    for (const SearchHit &hit : hits) {
+        QListWidgetItem *item = new QListWidgetItem(searchHitHtml(hit), ui->SearchListWidget);
+        item->setData(Qt::UserRole, hit.id);
+    }
+    if (done && ui->SearchListWidget->count() == 0) {
         ui->SearchListWidget->addItem("No tasks found.");
     }
-    db.close();
-
 }
 
 
@@ -703,8 +527,6 @@ void MainWindow::on_BackButtonSearch_clicked()
     ui->stackedWidget->setCurrentWidget(ui->page_2);
     ui->SearchLineEdit->clear();
     ui->SearchListWidget->clear();
-    refreshAllTasksFromDb();
-    displayTasks();
 }
 
 
@@ -716,69 +538,12 @@ void MainWindow::on_NotificationButton_clicked()
 
 void MainWindow::on_NotificationlistWidget_doubleClicked(const QModelIndex &index)
 {
-    QListWidgetItem* item = ui->NotificationlistWidget->item(index.row());
-    if (!item) return;
-
-    QString taskDetails = item->text();
-    QStringList details = taskDetails.split(" - ");
-    if (details.isEmpty()) {
-        QMessageBox::warning(this, "Selection Error", "Please select a valid task.");
-        return;
-    }
-
-    QString leftPart = details[0];
-    QRegularExpression re("^\\((\\d+)\\)\\s*(.+)$");
-    QRegularExpressionMatch match = re.match(leftPart);
-    if (!match.hasMatch()) {
-        QMessageBox::warning(this, "Parsing Error", "Could not extract task ID and title.");
-        return;
-    }
-
-    int id = match.captured(1).toInt();
-    Task t = getTaskById(id);
-    QStringList subTasksArray = t.subTasks.split(",", Qt::SkipEmptyParts);
-
-    TaskDialog dlg(t.title, t.description, t.dueDate, t.priority, subTasksArray, t.status, this);
-    dlg.setWindowTitle("Task Options");
-    dlg.exec();
-
-    QSqlDatabase db = QSqlDatabase::database();
-    if (!db.isOpen()) db.open();
-
-    QString newStatus;
-    switch (dlg.result()) {
-    case TaskActionDialogResult::SetToPending:
-        pushTaskToUndoStack(id);
-        newStatus = "pending";
-        break;
-    case TaskActionDialogResult::SetToComplete:
-        pushTaskToUndoStack(id);
-        newStatus = "complete";
-        break;
-    case TaskActionDialogResult::Delete: {
-        pushDeletedTaskToUndoStack(id);
-        QSqlQuery deleteQuery(db);
-        deleteQuery.prepare("DELETE FROM tasks WHERE id = ?");
-        deleteQuery.addBindValue(id);
-        deleteQuery.exec();
-        refreshAllTasksFromDb();
-        displayTasks();
-        QMessageBox::information(this, "Task Deleted", QString("The task '%1' has been deleted.").arg(t.title));
-        return;
-    }
-    default:
-        return;
-    }
-
-    QSqlQuery updateQuery(db);
-    updateQuery.prepare("UPDATE tasks SET status = ? WHERE id = ?");
-    updateQuery.addBindValue(newStatus);
-    updateQuery.addBindValue(id);
-    updateQuery.exec();
+    openTaskDialog(index);
+}
 
-    refreshAllTasksFromDb();
-    displayTasks();
-    QMessageBox::information(this, "Task Updated", QString("The task '%1' has been updated to '%2'.").arg(t.title, newStatus));
+void MainWindow::on_SearchListWidget_doubleClicked(const QModelIndex &index)
+{
+    openTaskDialog(index);
 }
 
 
@@ -788,73 +553,100 @@ void MainWindow::on_BackButtonNotif_clicked()
     ui->stackedWidget->setCurrentWidget(ui->page_2);
 }
 
-QString MainWindow::buildTaskJson(const Task& task, int level, bool isLastItem)
-    {
-        QString indent(level * 2, ' ');
-        QString json;
-
-        json += indent + "{\n";
-        json += indent + "  \"id\": " + QString::number(task.id) + ",\n";
-
-        QString escapedTitle = task.title;
-        escapedTitle.replace("\"", "\\\"");
-        json += indent + "  \"title\": \"" + escapedTitle + "\",\n";
-
-        QString escapedDesc = task.description;
-        escapedDesc.replace("\"", "\\\"");
-        json += indent + "  \"description\": \"" + escapedDesc + "\",\n";
-
-        json += indent + "  \"dueDate\": \"" + task.dueDate + "\",\n";
-        json += indent + "  \"priority\": " + QString::number(task.priority) + ",\n";
-        json += indent + "  \"status\": \"" + task.status + "\",\n";
-
-        if (!task.subTasks.isEmpty()) {
-            QString escapedSubTasks = task.subTasks;
-            escapedSubTasks.replace("\"", "\\\"");
-            json += indent + "  \"subtasks\": \"" + escapedSubTasks + "\"\n";
-        } else {
-            json += indent + "  \"subtasks\": \"\"\n";
-        }
-
-        json += indent + "}";
+void MainWindow::on_ExportButton_clicked()
+{
+    if (progressDialog)
+        return;
 
-        if (!isLastItem)
-            json += ",";
+    QString fileName = QFileDialog::getSaveFileName(this,
+                                                    tr("Export Tasks"), "",
+                                                    tr("JSON Files (*.json);;All Files (*)"));
+    if (fileName.isEmpty())
+        return;
 
-        json += "\n";
+    showProgressDialog("Exporting tasks...", 0);
+    connect(progressDialog, &QProgressDialog::canceled, this, [this]() {
+        dbWorker->cancelExport();
+        progressDialog->setLabelText("Cancelling...");
+    });
+    dbWorker->requestExport(fileName);
+}
 
-        return json;
+void MainWindow::onExportProgress(int written, int total)
+{
+    if (!progressDialog)
+        return;
+    if (total > 0) {
+        progressDialog->setMaximum(total);
+        progressDialog->setValue(qMin(written, total));
     }
+    progressDialog->setLabelText(QString("Exported %1 tasks...").arg(written));
+}
 
-    void MainWindow::on_ExportButton_clicked()
-    {
-        QString fileName = QFileDialog::getSaveFileName(this,
-                                                        tr("Export Tasks"), "",
-                                                        tr("JSON Files (*.json);;All Files (*)"));
+void MainWindow::onExportFinished(bool ok, int exported, const QString &error)
+{
+    closeProgressDialog();
+    if (ok) {
+        QMessageBox::information(this, "Export Successful",
+                                 QString("Exported %1 tasks.").arg(exported));
+    } else {
+        QMessageBox::warning(this, "Export Error", error);
+    }
+}
 
-        if (fileName.isEmpty())
-            return;
+void MainWindow::showProgressDialog(const QString &label, int maximum)
+{
+    progressDialog = new QProgressDialog(label, "Cancel", 0, maximum, this);
+    progressDialog->setWindowModality(Qt::WindowModal);
+    progressDialog->setMinimumDuration(0);
+    progressDialog->setAutoClose(false);
+    progressDialog->setAutoReset(false);
+    progressDialog->show();
+}
 
-        QFile file(fileName);
-        if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-            QMessageBox::warning(this, "Export Error", "Could not open file for writing.");
-            return;
-        }
+void MainWindow::closeProgressDialog()
+{
+    if (progressDialog) {
+        progressDialog->deleteLater();
+        progressDialog = nullptr;
+    }
+}
 
-        QTextStream out(&file);
+void MainWindow::on_ImportButton_clicked()
+{
+    if (progressDialog)
+        return;
 
-        out << "{\n";
-        out << "  \"tasks\": [\n";
+    QString fileName = QFileDialog::getOpenFileName(this,
+                                                    tr("Import Tasks"), "",
+                                                    tr("Task Files (*.json *.csv);;JSON Files (*.json);;CSV Files (*.csv);;All Files (*)"));
+    if (fileName.isEmpty())
+        return;
 
-        refreshAllTasksFromDb();
-        for (int i = 0; i < allTasks.size(); ++i) {
-            out << buildTaskJson(allTasks[i], 2, i == allTasks.size()-1);
-        }
+    showProgressDialog("Importing tasks...", 1000);
+    connect(progressDialog, &QProgressDialog::canceled, this, [this]() {
+        dbWorker->cancelImport();
+        progressDialog->setLabelText("Cancelling...");
+    });
+    dbWorker->requestImport(fileName);
+}
 
-        out << "  ]\n";
-        out << "}\n";
+void MainWindow::onImportProgress(qint64 bytesRead, qint64 totalBytes, int imported)
+{
+    if (!progressDialog)
+        return;
+    progressDialog->setValue(totalBytes > 0 ? int(bytesRead * 1000 / totalBytes) : 0);
+    progressDialog->setLabelText(QString("Read %1 tasks...").arg(imported));
+}
 
-        file.close();
-        QMessageBox::information(this, "Export Successful",
-                                 QString("Tasks exported to %1").arg(fileName));
+void MainWindow::onImportFinished(bool ok, int imported, const QString &error)
+{
+    closeProgressDialog();
+    refreshAllTasksFromDb();
+    if (ok) {
+        QMessageBox::information(this, "Import Successful", QString("Imported %1 tasks.").arg(imported));
+    } else {
+        QMessageBox::warning(this, "Import Stopped",
+                             QString("%1\n%2 tasks were imported before stopping.").arg(error).arg(imported));
     }
+}
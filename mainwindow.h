@@ -2,127 +2,21 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
-#include <QtSql>
-#include <QSqlDatabase>
-
-using namespace std;
-
-enum class TaskActionType { Update, Delete };
-
-struct Task {
-    int id;
-    QString title;
-    QString description;
-    QString dueDate;
-    QString subTasks;
-    int priority;
-    QString status;
-};
-
-
-struct TaskAction {
-    Task task;
-    TaskActionType type;
-};
-
-struct TaskNode {
-    Task data;
-    TaskNode* next;
-    TaskNode(Task t) : data(t), next(nullptr) {}
-};
-
-class TaskQueue {
-private:
-    TaskNode* front;
-    TaskNode* rear;
-
-public:
-    TaskQueue() : front(nullptr), rear(nullptr) {}
-
-    ~TaskQueue() {
-        while (front != nullptr) {
-            TaskNode* temp = front;
-            front = front->next;
-            delete temp;
-        }
-    }
-
-    void enqueue(const Task& task) {
-        TaskNode* newNode = new TaskNode(task);
-        if (rear == nullptr) { // kosong
-            front = rear = newNode;
-        } else {
-            rear->next = newNode;
-            rear = newNode;
-        }
-    }
-
-    bool isEmpty() const {
-        return front == nullptr;
-    }
-
-    Task dequeue() {
-        if (isEmpty()) {
-            throw std::runtime_error("Queue is empty");
-        }
-        TaskNode* temp = front;
-        Task ret = temp->data;
-        front = front->next;
-        if (front == nullptr) {
-            rear = nullptr;
-        }
-        delete temp;
-        return ret;
-    }
-};
-
-struct StackNode {
-    TaskAction data;
-    StackNode* next;
-};
-
-class Stack {
-    private:
-        StackNode* top;
-    public:
-        Stack() : top(nullptr) {}
-
-        ~Stack() {
-            while (top != nullptr) {
-                StackNode* temp = top;
-                top = top->next;
-                delete temp;
-            }
-        }
-
-        bool isEmpty() const {
-            return top == nullptr;
-        }
-
-        void clear() {
-            while (top != nullptr) {
-                StackNode* temp = top;
-                top = top->next;
-                delete temp;
-            }
-        }
-
-        void push_back(const TaskAction& action) {
-            StackNode* newNode = new StackNode{action, top};
-            top = newNode;
-        }
-
-        TaskAction takeLast() {
-            if (isEmpty()) {
-                throw out_of_range("Stack is empty");
-            }
-            StackNode* temp = top;
-            TaskAction result = top->data;
-            top = top->next;
-            delete temp;
-            return result;
-        }
-};
+#include <QScopedPointer>
+
+#include "task.h"
+#include "tasksearch.h"
+
+class TaskStore;
+class TaskHistory;
+class TaskDependencyTracker;
+class TaskScheduler;
+class DatabaseWorker;
+class QThread;
+class QTimer;
+class QProgressDialog;
+class TaskColumnModel;
+class QListView;
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -144,9 +38,6 @@ private slots:
     void displayTasksByDeadline();
     void displayTasksByPriority();
     void displayNotifications();
-    void pushTaskToUndoStack(const int id);
-    void pushDeletedTaskToUndoStack(const int id);
-    void pushTaskToRedoStack(const int id, TaskActionType type);
     void refreshAllTasksFromDb();
     void on_StartButton_clicked();
     void on_AddButton_clicked();
@@ -160,23 +51,53 @@ private slots:
     void on_RedoButton_clicked();
     void on_SearchPageButton_clicked();
     void on_SearchButton_clicked();
+    void on_SearchLineEdit_textChanged(const QString &text);
+    void onDatabaseOpened(bool ok, bool searchReady, const QString &error);
+    void onDatabaseError(const QString &error, bool wasWrite);
+    void onHistoryLoaded(const QVector<TaskAction> &undo, const QVector<TaskAction> &redo);
+    void onOpenTasksDueLoaded(const QVector<Task> &tasks);
+    void runSearch();
+    void onSearchResults(quint64 generation, const QVector<SearchHit> &hits, bool done);
     void on_BackButtonSearch_clicked();
     void on_NotificationButton_clicked();
     void on_NotificationlistWidget_doubleClicked(const QModelIndex &index);
+    void on_SearchListWidget_doubleClicked(const QModelIndex &index);
     void on_BackButtonNotif_clicked();
-    QString buildTaskJson(const Task& task, int level, bool isLastItem);
     void on_ExportButton_clicked();
+    void on_ImportButton_clicked();
+    void onImportProgress(qint64 bytesRead, qint64 totalBytes, int imported);
+    void onImportFinished(bool ok, int imported, const QString &error);
+    void onExportProgress(int written, int total);
+    void onExportFinished(bool ok, int exported, const QString &error);
 
 private:
     Ui::MainWindow *ui;
-    QVector<Task> allTasks;
-    Stack undoStack, redoStack;
-    QMap<int, QSet<int>> dependencyGraph;
-    void buildTaskDependencyGraph();
+    TaskStore *store;
+    bool searchIndexReady;
+    QThread *dbThread;
+    DatabaseWorker *dbWorker;
+    QTimer *searchTimer;
+    quint64 searchGeneration;
+    bool searchResultsPending;
+    QProgressDialog *progressDialog;
+    bool historyRestored;
+    TaskColumnModel *pendingModel, *inProgressModel, *completeModel;
+    QScopedPointer<TaskHistory> history;
+    TaskDependencyTracker *dependencyTracker;
+    TaskScheduler *scheduler;
     QVector<Task> getGraphRecommendedTasks(int maxRecs = 5);
     void updateRecommendations();
+    void setBoardOrder(TaskOrder order);
+    void openTaskDialog(const QModelIndex &index);
+    void addBulkActions(QListView *list);
+    QVector<int> selectedTaskIds(QListView *list) const;
+    void moveSelectedTasks(QListView *list, TaskStatus status);
+    void deleteSelectedTasks(QListView *list);
+    void applyDependencies(int id, const QVector<int> &dependsOn);
+    bool loadSnapshot();
+    void traceFirstBoardPaint();
+    void showProgressDialog(const QString &label, int maximum);
+    void closeProgressDialog();
 };
 
-int findTaskIndexById(const QVector<Task>& tasks, int id);
-
 #endif // MAINWINDOW_H
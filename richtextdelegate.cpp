@@ -0,0 +1,46 @@
+#include "richtextdelegate.h"
+#include <QAbstractTextDocumentLayout>
+#include <QApplication>
+#include <QPainter>
+#include <QTextDocument>
+#include <QtMath>
+
+void RichTextDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    QStyleOptionViewItem opt = option;
+    initStyleOption(&opt, index);
+
+    QTextDocument doc;
+    doc.setHtml(opt.text);
+    opt.text.clear();
+
+    const QWidget *widget = opt.widget;
+    QStyle *style = widget ? widget->style() : QApplication::style();
+    style->drawControl(QStyle::CE_ItemViewItem, &opt, painter, widget);
+
+    QRect textRect = style->subElementRect(QStyle::SE_ItemViewItemText, &opt, widget);
+    doc.setTextWidth(textRect.width());
+
+    QAbstractTextDocumentLayout::PaintContext ctx;
+    ctx.palette = opt.palette;
+    if (opt.state & QStyle::State_Selected)
+        ctx.palette.setColor(QPalette::Text, opt.palette.color(QPalette::HighlightedText));
+
+    painter->save();
+    painter->translate(textRect.topLeft());
+    painter->setClipRect(textRect.translated(-textRect.topLeft()));
+    doc.documentLayout()->draw(painter, ctx);
+    painter->restore();
+}
+
+QSize RichTextDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    QStyleOptionViewItem opt = option;
+    initStyleOption(&opt, index);
+
+    QTextDocument doc;
+    doc.setHtml(opt.text);
+    if (opt.rect.width() > 0)
+        doc.setTextWidth(opt.rect.width());
+    return QSize(qCeil(doc.idealWidth()), qCeil(doc.size().height()));
+}
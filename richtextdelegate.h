@@ -0,0 +1,17 @@
+#ifndef RICHTEXTDELEGATE_H
+#define RICHTEXTDELEGATE_H
+
+#include <QStyledItemDelegate>
+
+// Renders the display text of an item as HTML, used for search snippets.
+class RichTextDelegate : public QStyledItemDelegate {
+    Q_OBJECT
+
+public:
+    using QStyledItemDelegate::QStyledItemDelegate;
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+};
+
+#endif // RICHTEXTDELEGATE_H
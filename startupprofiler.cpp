@@ -0,0 +1,70 @@
+#include "startupprofiler.h"
+#include <QEvent>
+#include <QWidget>
+#include <cstdio>
+
+StartupProfiler::StartupProfiler()
+    : m_lastNs(0), m_print(qEnvironmentVariableIsSet("TODO_STARTUP_TRACE"))
+{
+    m_timer.start();
+}
+
+StartupProfiler *StartupProfiler::instance()
+{
+    static StartupProfiler profiler;
+    return &profiler;
+}
+
+void StartupProfiler::start(bool print)
+{
+    StartupProfiler *self = instance();
+    for (auto it = self->m_paintMarks.cbegin(); it != self->m_paintMarks.cend(); ++it)
+        it.key()->removeEventFilter(self);
+    self->m_paintMarks.clear();
+    self->m_print = print || qEnvironmentVariableIsSet("TODO_STARTUP_TRACE");
+    self->m_lastNs = 0;
+    self->m_timer.restart();
+}
+
+void StartupProfiler::mark(const char *phase)
+{
+    instance()->record(phase);
+}
+
+void StartupProfiler::markOnNextPaint(QWidget *widget, const char *phase)
+{
+    StartupProfiler *self = instance();
+    if (!self->m_paintMarks.contains(widget))
+        widget->installEventFilter(self);
+    self->m_paintMarks.insert(widget, phase);
+    connect(widget, &QObject::destroyed, self, [self, widget]() {
+        self->m_paintMarks.remove(widget);
+    });
+}
+
+bool StartupProfiler::eventFilter(QObject *watched, QEvent *event)
+{
+    if (event->type() == QEvent::Paint) {
+        auto it = m_paintMarks.find(watched);
+        if (it != m_paintMarks.end()) {
+            const char *phase = it.value();
+            m_paintMarks.erase(it);
+            watched->removeEventFilter(this);
+            // The paint itself runs after this filter returns; record the
+            // phase once control is back in the event loop.
+            QMetaObject::invokeMethod(this, [this, phase]() { record(phase); }, Qt::QueuedConnection);
+        }
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+void StartupProfiler::record(const char *phase)
+{
+    const qint64 ns = m_timer.nsecsElapsed();
+    if (m_print) {
+        std::fprintf(stderr, "[startup] %9.2f ms  (+%8.2f ms)  %s\n",
+                     ns / 1e6, (ns - m_lastNs) / 1e6, phase);
+    }
+    m_lastNs = ns;
+    emit phaseReached(QString::fromLatin1(phase), ns);
+}
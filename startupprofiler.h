@@ -0,0 +1,45 @@
+#ifndef STARTUPPROFILER_H
+#define STARTUPPROFILER_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QString>
+
+class QWidget;
+
+// Times named startup phases from one clock started in main(). Phases are
+// always recorded; they are printed to stderr only when TODO_STARTUP_TRACE
+// is set or the app is started with --startup-trace.
+class StartupProfiler : public QObject {
+    Q_OBJECT
+
+public:
+    static StartupProfiler *instance();
+
+    // Restarts the clock and forgets pending paint marks.
+    static void start(bool print);
+    static void mark(const char *phase);
+    // Marks phase the next time widget paints.
+    static void markOnNextPaint(QWidget *widget, const char *phase);
+
+    qint64 elapsedNs() const { return m_timer.nsecsElapsed(); }
+
+signals:
+    void phaseReached(const QString &phase, qint64 elapsedNs);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    StartupProfiler();
+
+    QElapsedTimer m_timer;
+    qint64 m_lastNs;
+    bool m_print;
+    QHash<QObject *, const char *> m_paintMarks;
+
+    void record(const char *phase);
+};
+
+#endif // STARTUPPROFILER_H
@@ -0,0 +1,133 @@
+#ifndef TASK_H
+#define TASK_H
+
+#include <QDate>
+#include <QMetaType>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <limits>
+
+using namespace std;
+
+enum class TaskActionType { Update, Delete };
+
+enum class TaskStatus : quint8 { Pending, InProgress, Complete };
+
+enum class TaskOrder { ById, ByDueDate, ByPriority };
+
+// Due dates are held as Julian day numbers; tasks without one sort last.
+const qint32 kNoDueDay = std::numeric_limits<qint32>::max();
+
+struct Task {
+    int id;
+    QString title;
+    QString description;
+    qint32 dueDay;
+    QStringList subTasks;
+    int priority;
+    TaskStatus status;
+};
+
+Q_DECLARE_METATYPE(Task)
+
+// Text forms, used only at the edges: display, SQL, import and export.
+inline QString taskStatusText(TaskStatus status)
+{
+    switch (status) {
+    case TaskStatus::InProgress:
+        return QStringLiteral("in progress");
+    case TaskStatus::Complete:
+        return QStringLiteral("complete");
+    case TaskStatus::Pending:
+        break;
+    }
+    return QStringLiteral("pending");
+}
+
+inline bool parseTaskStatus(const QString &text, TaskStatus *status)
+{
+    if (text == QLatin1String("pending"))
+        *status = TaskStatus::Pending;
+    else if (text == QLatin1String("in progress"))
+        *status = TaskStatus::InProgress;
+    else if (text == QLatin1String("complete"))
+        *status = TaskStatus::Complete;
+    else
+        return false;
+    return true;
+}
+
+inline QString dueDayText(qint32 dueDay)
+{
+    if (dueDay == kNoDueDay)
+        return QString();
+    return QDate::fromJulianDay(dueDay).toString("yyyy-MM-dd");
+}
+
+// Empty text means no due date; anything else must be yyyy-MM-dd.
+inline bool parseDueDay(const QString &text, qint32 *dueDay)
+{
+    if (text.isEmpty()) {
+        *dueDay = kNoDueDay;
+        return true;
+    }
+    const QDate date = QDate::fromString(text, "yyyy-MM-dd");
+    if (!date.isValid())
+        return false;
+    *dueDay = qint32(date.toJulianDay());
+    return true;
+}
+
+// Sub-tasks are stored as one comma-separated string.
+inline QStringList splitSubTasks(const QString &text)
+{
+    QStringList subTasks;
+    for (const QString &part : text.split(',', Qt::SkipEmptyParts)) {
+        const QString trimmed = part.trimmed();
+        if (!trimmed.isEmpty())
+            subTasks.append(trimmed);
+    }
+    return subTasks;
+}
+
+inline QString joinSubTasks(const QStringList &subTasks)
+{
+    return subTasks.join(',');
+}
+
+// taskId cannot start until dependsOn is complete.
+struct TaskDependency {
+    int taskId;
+    int dependsOn;
+};
+
+Q_DECLARE_METATYPE(TaskDependency)
+
+
+// One entry in the undo history. An Update keeps only the fields in its
+// mask, holding whichever side of the edit the store is not showing, so
+// undo and redo both swap them with the store's copy. A Delete keeps the
+// whole task and the dependency edges it had, which go back with it.
+// Strings are implicitly shared with the store's copy.
+struct TaskAction {
+    enum Field : quint8 {
+        Title = 0x01,
+        Description = 0x02,
+        DueDay = 0x04,
+        SubTasks = 0x08,
+        Priority = 0x10,
+        Status = 0x20,
+        AllFields = 0x3f
+    };
+
+    Task task;
+    TaskActionType type;
+    quint8 fields;
+    bool joined;  // undone and redone together with the action before it
+    QVector<TaskDependency> edges;  // Delete only
+};
+
+Q_DECLARE_METATYPE(TaskAction)
+
+#endif // TASK_H
@@ -0,0 +1,259 @@
+#include "taskcolumnmodel.h"
+#include "taskstore.h"
+
+TaskColumnModel::TaskColumnModel(TaskStatus status, QObject *parent)
+    : QAbstractListModel(parent), m_store(nullptr), m_status(status), m_order(TaskOrder::ById)
+{
+    for (int i = 0; i < 3; ++i)
+        m_permutations[i] = TaskPermutation(TaskOrder(i));
+}
+
+void TaskColumnModel::setStore(TaskStore *store)
+{
+    if (m_store)
+        disconnect(m_store, nullptr, this, nullptr);
+    m_store = store;
+    if (m_store) {
+        connect(m_store, &TaskStore::tasksReset, this, &TaskColumnModel::resetFromStore);
+        connect(m_store, &TaskStore::taskAdded, this, &TaskColumnModel::addTask);
+        connect(m_store, &TaskStore::taskUpdated, this, &TaskColumnModel::updateTask);
+        connect(m_store, &TaskStore::taskRemoved, this, &TaskColumnModel::removeTask);
+        connect(m_store, &TaskStore::tasksChanged, this, &TaskColumnModel::applyChanges);
+    }
+    resetFromStore();
+}
+
+void TaskColumnModel::resetFromStore()
+{
+    beginResetModel();
+    m_placed.clear();
+    if (!m_store) {
+        for (TaskPermutation &permutation : m_permutations)
+            permutation.clear();
+        endResetModel();
+        return;
+    }
+
+    const TaskColumns &columns = m_store->columns();
+    QVector<int> indices;
+    for (int i = 0; i < columns.statuses.size(); ++i) {
+        if (columns.statuses[i] == m_status)
+            indices.push_back(i);
+    }
+    m_placed.reserve(indices.size());
+    for (int idx : indices)
+        m_placed.insert(columns.ids[idx], {columns.dueDays[idx], columns.priorities[idx]});
+    for (TaskPermutation &permutation : m_permutations)
+        permutation.reset(columns, indices);
+    endResetModel();
+}
+
+int TaskColumnModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return current().size();
+}
+
+QVariant TaskColumnModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= current().size() || !m_store)
+        return QVariant();
+
+    const Task *t = m_store->taskById(current().idAt(index.row()));
+    if (!t)
+        return QVariant();
+    switch (role) {
+    case Qt::DisplayRole:
+        return "(" + QString::number(t->id) + ") " + t->title + " - Due: " + dueDayText(t->dueDay);
+    case TaskIdRole:
+        return t->id;
+    case StatusRole:
+        return int(t->status);
+    case PriorityRole:
+        return t->priority;
+    case DueDateRole:
+        return t->dueDay;
+    default:
+        return QVariant();
+    }
+}
+
+void TaskColumnModel::setOrder(TaskOrder order)
+{
+    if (order == m_order)
+        return;
+
+    emit layoutAboutToBeChanged();
+    const TaskPermutation &next = m_permutations[int(order)];
+    const QModelIndexList from = persistentIndexList();
+    QModelIndexList to;
+    for (const QModelIndex &idx : from)
+        to.push_back(index(next.rowOf(placedEntry(next, current().idAt(idx.row())))));
+    m_order = order;
+    changePersistentIndexList(from, to);
+    emit layoutChanged();
+}
+
+TaskSortEntry TaskColumnModel::placedEntry(const TaskPermutation &permutation, int id) const
+{
+    const Placed placed = m_placed.value(id);
+    return permutation.entry(id, placed.dueDay, placed.priority);
+}
+
+void TaskColumnModel::insert(const Task &task)
+{
+    m_placed.insert(task.id, {task.dueDay, qint8(task.priority)});
+    for (int i = 0; i < 3; ++i) {
+        TaskPermutation &permutation = m_permutations[i];
+        const TaskSortEntry entry = placedEntry(permutation, task.id);
+        const int row = permutation.lowerBound(entry);
+        if (i != int(m_order)) {
+            permutation.insertAt(row, entry);
+            continue;
+        }
+        beginInsertRows(QModelIndex(), row, row);
+        permutation.insertAt(row, entry);
+        endInsertRows();
+    }
+}
+
+void TaskColumnModel::remove(int id)
+{
+    for (int i = 0; i < 3; ++i) {
+        TaskPermutation &permutation = m_permutations[i];
+        const int row = permutation.rowOf(placedEntry(permutation, id));
+        // m_placed and the permutations always agree; a miss is a bug.
+        Q_ASSERT(row >= 0);
+        if (row < 0)
+            continue;
+        if (i != int(m_order)) {
+            permutation.removeAt(row);
+            continue;
+        }
+        beginRemoveRows(QModelIndex(), row, row);
+        permutation.removeAt(row);
+        endRemoveRows();
+    }
+    m_placed.remove(id);
+}
+
+void TaskColumnModel::addTask(const Task &task)
+{
+    if (m_placed.contains(task.id))
+        updateTask(task);
+    else if (task.status == m_status)
+        insert(task);
+}
+
+void TaskColumnModel::updateTask(const Task &task)
+{
+    if (!m_placed.contains(task.id)) {
+        if (task.status == m_status)
+            insert(task);
+        return;
+    }
+    if (task.status != m_status) {
+        remove(task.id);
+        return;
+    }
+
+    const Placed old = m_placed.value(task.id);
+    const Placed now = {task.dueDay, qint8(task.priority)};
+    for (int i = 0; i < 3; ++i) {
+        TaskPermutation &permutation = m_permutations[i];
+        const int fromRow = permutation.rowOf(permutation.entry(task.id, old.dueDay, old.priority));
+        Q_ASSERT(fromRow >= 0);
+        if (fromRow < 0)
+            continue;
+        const TaskSortEntry entry = permutation.entry(task.id, now.dueDay, now.priority);
+        // Found while the task is still in place, which is the row
+        // numbering beginMoveRows() wants for the destination.
+        const int dest = permutation.lowerBound(entry);
+        const int row = dest > fromRow ? dest - 1 : dest;
+        const bool moves = i == int(m_order) && dest != fromRow && dest != fromRow + 1;
+        if (moves)
+            beginMoveRows(QModelIndex(), fromRow, fromRow, QModelIndex(), dest);
+        permutation.removeAt(fromRow);
+        permutation.insertAt(row, entry);
+        if (moves)
+            endMoveRows();
+        if (i == int(m_order))
+            emit dataChanged(index(row), index(row));
+    }
+    m_placed.insert(task.id, now);
+}
+
+void TaskColumnModel::removeTask(int id)
+{
+    if (m_placed.contains(id))
+        remove(id);
+}
+
+void TaskColumnModel::applyChanges(const QVector<Task> &changed, const QVector<int> &removed)
+{
+    QSet<int> leaving;
+    QVector<const Task *> arriving;
+    QVector<int> touched;   // staying on the same rows
+    for (int id : removed) {
+        if (m_placed.contains(id))
+            leaving.insert(id);
+    }
+    for (const Task &task : changed) {
+        const bool placed = m_placed.contains(task.id);
+        if (task.status != m_status) {
+            if (placed)
+                leaving.insert(task.id);
+            continue;
+        }
+        if (placed) {
+            const Placed old = m_placed.value(task.id);
+            if (old.dueDay == task.dueDay && old.priority == task.priority) {
+                touched.push_back(task.id);
+                continue;
+            }
+            leaving.insert(task.id);
+        }
+        arriving.push_back(&task);
+    }
+
+    if (leaving.isEmpty() && arriving.isEmpty()) {
+        for (int id : touched) {
+            const int row = current().rowOf(placedEntry(current(), id));
+            Q_ASSERT(row >= 0);
+            if (row >= 0)
+                emit dataChanged(index(row), index(row));
+        }
+        return;
+    }
+
+    // One pass per permutation and a single relayout, rather than a row
+    // signal and an array shift per task. Persistent indexes are carried
+    // over as in setOrder(), so selection, the current row and the scroll
+    // position survive; those of departed tasks become invalid.
+    emit layoutAboutToBeChanged();
+    const QModelIndexList from = persistentIndexList();
+    QVector<int> fromIds;
+    fromIds.reserve(from.size());
+    for (const QModelIndex &idx : from)
+        fromIds.push_back(current().idAt(idx.row()));
+
+    for (int id : leaving)
+        m_placed.remove(id);
+    for (const Task *task : arriving)
+        m_placed.insert(task->id, {task->dueDay, qint8(task->priority)});
+    for (TaskPermutation &permutation : m_permutations) {
+        permutation.removeIds(leaving);
+        QVector<TaskSortEntry> entries;
+        entries.reserve(arriving.size());
+        for (const Task *task : arriving)
+            entries.push_back(placedEntry(permutation, task->id));
+        permutation.merge(entries);
+    }
+
+    QModelIndexList to;
+    for (int id : fromIds)
+        to.push_back(m_placed.contains(id) ? index(current().rowOf(placedEntry(current(), id))) : QModelIndex());
+    changePersistentIndexList(from, to);
+    emit layoutChanged();
+}
@@ -0,0 +1,63 @@
+#ifndef TASKCOLUMNMODEL_H
+#define TASKCOLUMNMODEL_H
+
+#include <QAbstractListModel>
+#include <QHash>
+
+#include "task.h"
+#include "taskorder.h"
+
+class TaskStore;
+
+// One board column: the store's tasks with one status, in the selected
+// order. Each order is kept as its own permutation and patched on every
+// store edit, so switching order is a relayout rather than a sort or a
+// reload.
+class TaskColumnModel : public QAbstractListModel {
+    Q_OBJECT
+
+public:
+    enum Roles {
+        TaskIdRole = Qt::UserRole,
+        StatusRole,     // int(TaskStatus)
+        PriorityRole,
+        DueDateRole     // Julian day, kNoDueDay when unset
+    };
+
+    explicit TaskColumnModel(TaskStatus status, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    void setStore(TaskStore *store);
+
+    TaskOrder order() const { return m_order; }
+    void setOrder(TaskOrder order);
+
+private slots:
+    void resetFromStore();
+    void addTask(const Task &task);
+    void updateTask(const Task &task);
+    void removeTask(int id);
+    void applyChanges(const QVector<Task> &changed, const QVector<int> &removed);
+
+private:
+    // The fields a task was filed under, to find it again after an edit.
+    struct Placed {
+        qint32 dueDay;
+        qint8 priority;
+    };
+
+    TaskStore *m_store;
+    TaskStatus m_status;
+    TaskOrder m_order;
+    TaskPermutation m_permutations[3];  // indexed by TaskOrder
+    QHash<int, Placed> m_placed;
+
+    const TaskPermutation &current() const { return m_permutations[int(m_order)]; }
+    TaskSortEntry placedEntry(const TaskPermutation &permutation, int id) const;
+    void insert(const Task &task);
+    void remove(int id);
+};
+
+#endif // TASKCOLUMNMODEL_H
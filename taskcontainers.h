@@ -0,0 +1,181 @@
+#ifndef TASKCONTAINERS_H
+#define TASKCONTAINERS_H
+
+#include <new>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "task.h"
+
+// FIFO queue over a single ring buffer that doubles when full. Dequeued
+// slots are reused, so a queue that stays around the same size stops
+// allocating once it has grown to it. Elements are moved in and out.
+template <typename T>
+class RingQueue {
+public:
+    RingQueue() : m_slots(nullptr), m_capacity(0), m_head(0), m_size(0) {}
+    ~RingQueue()
+    {
+        clear();
+        ::operator delete(m_slots);
+    }
+
+    RingQueue(const RingQueue &) = delete;
+    RingQueue &operator=(const RingQueue &) = delete;
+
+    bool isEmpty() const { return m_size == 0; }
+    int size() const { return m_size; }
+    int capacity() const { return m_capacity; }
+
+    void reserve(int capacity)
+    {
+        if (capacity <= m_capacity)
+            return;
+        capacity = roundUp(capacity);
+        adopt(static_cast<T *>(::operator new(sizeof(T) * capacity)), capacity);
+    }
+
+    void enqueue(const T &value) { emplace(value); }
+    void enqueue(T &&value) { emplace(std::move(value)); }
+
+    // The element is built before anything is counted or moved, so a
+    // throwing constructor leaves the queue as it was.
+    template <typename... Args>
+    T &emplace(Args &&...args)
+    {
+        if (m_size < m_capacity) {
+            T *end = m_slots + slot(m_size);
+            new (end) T(std::forward<Args>(args)...);
+            ++m_size;
+            return *end;
+        }
+        // Built in the new buffer before the old elements move, so args
+        // may refer to one of them.
+        const int capacity = m_capacity ? m_capacity * 2 : kInitialCapacity;
+        T *slots = static_cast<T *>(::operator new(sizeof(T) * capacity));
+        try {
+            new (slots + m_size) T(std::forward<Args>(args)...);
+        } catch (...) {
+            ::operator delete(slots);
+            throw;
+        }
+        adopt(slots, capacity);
+        ++m_size;
+        return m_slots[m_size - 1];
+    }
+
+    T &front() { return m_slots[m_head]; }
+    const T &front() const { return m_slots[m_head]; }
+    T &last() { return m_slots[slot(m_size - 1)]; }
+    const T &last() const { return m_slots[slot(m_size - 1)]; }
+    // i counts from the front.
+    const T &at(int i) const { return m_slots[slot(i)]; }
+
+    T dequeue()
+    {
+        if (isEmpty())
+            throw std::runtime_error("Queue is empty");
+        T *first = m_slots + m_head;
+        T value(std::move(*first));
+        first->~T();
+        m_head = (m_head + 1) & (m_capacity - 1);
+        --m_size;
+        return value;
+    }
+
+    // Takes from the back, so the queue can also serve as a bounded stack
+    // that drops its oldest entries from the front.
+    T takeLast()
+    {
+        if (isEmpty())
+            throw std::runtime_error("Queue is empty");
+        T *back = m_slots + slot(m_size - 1);
+        T value(std::move(*back));
+        back->~T();
+        --m_size;
+        return value;
+    }
+
+    // Keeps the buffer for reuse.
+    void clear()
+    {
+        for (; m_size > 0; --m_size) {
+            m_slots[m_head].~T();
+            m_head = (m_head + 1) & (m_capacity - 1);
+        }
+        m_head = 0;
+    }
+
+private:
+    static const int kInitialCapacity = 16;
+
+    T *m_slots;
+    int m_capacity;  // zero or a power of two
+    int m_head;
+    int m_size;
+
+    int slot(int i) const { return (m_head + i) & (m_capacity - 1); }
+
+    static int roundUp(int capacity)
+    {
+        int rounded = kInitialCapacity;
+        while (rounded < capacity)
+            rounded *= 2;
+        return rounded;
+    }
+
+    // Moves the elements to the front of slots, in order, and frees the
+    // old buffer.
+    void adopt(T *slots, int capacity)
+    {
+        for (int i = 0; i < m_size; ++i) {
+            T *old = m_slots + slot(i);
+            new (slots + i) T(std::move(*old));
+            old->~T();
+        }
+        ::operator delete(m_slots);
+        m_slots = slots;
+        m_capacity = capacity;
+        m_head = 0;
+    }
+};
+
+// LIFO stack over one contiguous array. Popping keeps the capacity, so a
+// stack that is pushed and popped in turn stops allocating.
+template <typename T>
+class Stack {
+public:
+    bool isEmpty() const { return m_items.empty(); }
+    int size() const { return int(m_items.size()); }
+    void reserve(int capacity) { m_items.reserve(capacity); }
+    void clear() { m_items.clear(); }
+
+    void push_back(const T &value) { m_items.push_back(value); }
+    void push_back(T &&value) { m_items.push_back(std::move(value)); }
+
+    template <typename... Args>
+    T &emplace_back(Args &&...args) { return m_items.emplace_back(std::forward<Args>(args)...); }
+
+    T &last() { return m_items.back(); }
+    const T &last() const { return m_items.back(); }
+    // i counts from the bottom.
+    const T &at(int i) const { return m_items[i]; }
+
+    T takeLast()
+    {
+        if (isEmpty())
+            throw std::out_of_range("Stack is empty");
+        T value(std::move(m_items.back()));
+        m_items.pop_back();
+        return value;
+    }
+
+private:
+    std::vector<T> m_items;
+};
+
+using TaskQueue = RingQueue<Task>;
+using TaskActionStack = Stack<TaskAction>;
+
+#endif // TASKCONTAINERS_H
@@ -0,0 +1,297 @@
+#include "taskdag.h"
+#include <algorithm>
+
+TaskDag::TaskDag()
+    : m_edgeCount(0), m_visitStamp(0), m_chainDirty(false)
+{
+}
+
+int TaskDag::nodeFor(int id)
+{
+    auto it = m_indexById.constFind(id);
+    if (it != m_indexById.constEnd())
+        return *it;
+    const int node = m_nodes.size();
+    m_nodes.push_back(Node{id, QVector<int>(), QVector<int>()});
+    m_indexById.insert(id, node);
+    m_position.push_back(m_nodeAt.size());
+    m_nodeAt.push_back(node);
+    m_visited.push_back(0);
+    return node;
+}
+
+int TaskDag::nextStamp()
+{
+    if (++m_visitStamp == 0) {
+        m_visited.fill(0);
+        m_visitStamp = 1;
+    }
+    return m_visitStamp;
+}
+
+void TaskDag::reset(const QVector<TaskDependency> &edges)
+{
+    m_nodes.clear();
+    m_indexById.clear();
+    m_position.clear();
+    m_nodeAt.clear();
+    m_visited.clear();
+    m_edgeCount = 0;
+    m_chainDirty = true;
+
+    // Edges from the database are acyclic unless someone wrote to it behind
+    // our back, so add them all and sort once; only fall back to adding them
+    // one at a time if that finds a cycle.
+    for (const TaskDependency &edge : edges) {
+        if (edge.taskId == edge.dependsOn)
+            continue;
+        const int task = nodeFor(edge.taskId);
+        const int dependsOn = nodeFor(edge.dependsOn);
+        if (m_nodes[task].dependencies.contains(dependsOn))
+            continue;
+        m_nodes[task].dependencies.push_back(dependsOn);
+        m_nodes[dependsOn].dependents.push_back(task);
+        ++m_edgeCount;
+    }
+    if (sortAll())
+        return;
+
+    for (Node &node : m_nodes) {
+        node.dependencies.clear();
+        node.dependents.clear();
+    }
+    m_edgeCount = 0;
+    for (const TaskDependency &edge : edges)
+        addDependency(edge.taskId, edge.dependsOn);
+}
+
+bool TaskDag::sortAll()
+{
+    // Kahn's algorithm; false if some nodes sit on a cycle.
+    const int count = m_nodes.size();
+    QVector<int> waiting(count);
+    QVector<int> order;
+    order.reserve(count);
+    for (int node = 0; node < count; ++node) {
+        waiting[node] = m_nodes[node].dependencies.size();
+        if (waiting[node] == 0)
+            order.push_back(node);
+    }
+    for (int head = 0; head < order.size(); ++head) {
+        for (int dependent : m_nodes[order[head]].dependents) {
+            if (--waiting[dependent] == 0)
+                order.push_back(dependent);
+        }
+    }
+    if (order.size() != count)
+        return false;
+
+    m_nodeAt = order;
+    for (int place = 0; place < count; ++place)
+        m_position[m_nodeAt[place]] = place;
+    return true;
+}
+
+bool TaskDag::addDependency(int taskId, int dependsOn)
+{
+    if (taskId == dependsOn)
+        return false;
+    if (hasDependency(taskId, dependsOn))
+        return true;
+
+    const int task = nodeFor(taskId);
+    const int dependency = nodeFor(dependsOn);
+    const int lower = m_position[task];
+    const int upper = m_position[dependency];
+
+    if (upper > lower) {
+        // The dependency sits after the task. Whatever must follow the task
+        // and lies before the dependency has to move behind it, along with
+        // everything the dependency needs from that stretch.
+        QVector<int> forward;
+        if (!collectForward(task, upper, dependency, forward))
+            return false;
+        QVector<int> backward;
+        collectBackward(dependency, lower, backward);
+
+        auto byPosition = [this](int a, int b) { return m_position[a] < m_position[b]; };
+        std::sort(forward.begin(), forward.end(), byPosition);
+        std::sort(backward.begin(), backward.end(), byPosition);
+
+        QVector<int> places;
+        places.reserve(forward.size() + backward.size());
+        for (int node : backward)
+            places.push_back(m_position[node]);
+        for (int node : forward)
+            places.push_back(m_position[node]);
+        std::sort(places.begin(), places.end());
+
+        int next = 0;
+        for (const QVector<int> *nodes : {&backward, &forward}) {
+            for (int node : *nodes) {
+                m_position[node] = places[next];
+                m_nodeAt[places[next]] = node;
+                ++next;
+            }
+        }
+    }
+
+    m_nodes[task].dependencies.push_back(dependency);
+    m_nodes[dependency].dependents.push_back(task);
+    ++m_edgeCount;
+    m_chainDirty = true;
+    return true;
+}
+
+bool TaskDag::collectForward(int start, int upper, int target, QVector<int> &found)
+{
+    const int stamp = nextStamp();
+    QVector<int> stack{start};
+    m_visited[start] = stamp;
+    while (!stack.isEmpty()) {
+        const int node = stack.takeLast();
+        found.push_back(node);
+        for (int dependent : m_nodes[node].dependents) {
+            if (dependent == target)
+                return false;
+            if (m_visited[dependent] != stamp && m_position[dependent] < upper) {
+                m_visited[dependent] = stamp;
+                stack.push_back(dependent);
+            }
+        }
+    }
+    return true;
+}
+
+void TaskDag::collectBackward(int start, int lower, QVector<int> &found)
+{
+    const int stamp = nextStamp();
+    QVector<int> stack{start};
+    m_visited[start] = stamp;
+    while (!stack.isEmpty()) {
+        const int node = stack.takeLast();
+        found.push_back(node);
+        for (int dependency : m_nodes[node].dependencies) {
+            if (m_visited[dependency] != stamp && m_position[dependency] > lower) {
+                m_visited[dependency] = stamp;
+                stack.push_back(dependency);
+            }
+        }
+    }
+}
+
+bool TaskDag::removeDependency(int taskId, int dependsOn)
+{
+    const int task = m_indexById.value(taskId, -1);
+    const int dependency = m_indexById.value(dependsOn, -1);
+    if (task == -1 || dependency == -1 || !m_nodes[task].dependencies.removeOne(dependency))
+        return false;
+    // Dropping an edge never invalidates the order.
+    m_nodes[dependency].dependents.removeOne(task);
+    --m_edgeCount;
+    m_chainDirty = true;
+    return true;
+}
+
+void TaskDag::removeTask(int id)
+{
+    const int node = m_indexById.value(id, -1);
+    if (node == -1)
+        return;
+    // The node keeps its place in the order, so a restored task can reuse it.
+    for (int dependency : m_nodes[node].dependencies)
+        m_nodes[dependency].dependents.removeOne(node);
+    for (int dependent : m_nodes[node].dependents)
+        m_nodes[dependent].dependencies.removeOne(node);
+    m_edgeCount -= m_nodes[node].dependencies.size() + m_nodes[node].dependents.size();
+    m_nodes[node].dependencies.clear();
+    m_nodes[node].dependents.clear();
+    m_chainDirty = true;
+}
+
+bool TaskDag::hasDependency(int taskId, int dependsOn) const
+{
+    const int task = m_indexById.value(taskId, -1);
+    const int dependency = m_indexById.value(dependsOn, -1);
+    return task != -1 && dependency != -1 && m_nodes[task].dependencies.contains(dependency);
+}
+
+bool TaskDag::hasEdges(int id) const
+{
+    const int node = m_indexById.value(id, -1);
+    return node != -1 && (!m_nodes[node].dependencies.isEmpty() || !m_nodes[node].dependents.isEmpty());
+}
+
+QVector<int> TaskDag::dependenciesOf(int id) const
+{
+    QVector<int> ids;
+    const int node = m_indexById.value(id, -1);
+    if (node == -1)
+        return ids;
+    ids.reserve(m_nodes[node].dependencies.size());
+    for (int dependency : m_nodes[node].dependencies)
+        ids.push_back(m_nodes[dependency].id);
+    return ids;
+}
+
+QVector<int> TaskDag::dependentsOf(int id) const
+{
+    QVector<int> ids;
+    const int node = m_indexById.value(id, -1);
+    if (node == -1)
+        return ids;
+    ids.reserve(m_nodes[node].dependents.size());
+    for (int dependent : m_nodes[node].dependents)
+        ids.push_back(m_nodes[dependent].id);
+    return ids;
+}
+
+QVector<TaskDependency> TaskDag::edgesOf(int id) const
+{
+    QVector<TaskDependency> edges;
+    const int node = m_indexById.value(id, -1);
+    if (node == -1)
+        return edges;
+    for (int dependency : m_nodes[node].dependencies)
+        edges.push_back({id, m_nodes[dependency].id});
+    for (int dependent : m_nodes[node].dependents)
+        edges.push_back({m_nodes[dependent].id, id});
+    return edges;
+}
+
+void TaskDag::updateChains() const
+{
+    if (!m_chainDirty)
+        return;
+    // Dependents always come later in the order, so one backwards pass
+    // sees every dependent's chain before the task it waits on.
+    m_chain.fill(0, m_nodes.size());
+    for (int place = m_nodeAt.size() - 1; place >= 0; --place) {
+        const int node = m_nodeAt[place];
+        int longest = 0;
+        for (int dependent : m_nodes[node].dependents)
+            longest = qMax(longest, m_chain[dependent] + 1);
+        m_chain[node] = longest;
+    }
+    m_chainDirty = false;
+}
+
+int TaskDag::chainLength(int id) const
+{
+    const int node = m_indexById.value(id, -1);
+    if (node == -1)
+        return 0;
+    updateChains();
+    return m_chain[node];
+}
+
+QVector<int> TaskDag::topologicalOrder() const
+{
+    QVector<int> ids;
+    ids.reserve(m_nodeAt.size());
+    for (int node : m_nodeAt) {
+        if (!m_nodes[node].dependencies.isEmpty() || !m_nodes[node].dependents.isEmpty())
+            ids.push_back(m_nodes[node].id);
+    }
+    return ids;
+}
@@ -0,0 +1,66 @@
+#ifndef TASKDAG_H
+#define TASKDAG_H
+
+#include <QHash>
+#include <QVector>
+
+#include "task.h"
+
+// Explicit task dependencies, kept acyclic. A topological order is
+// maintained as edges arrive (Pearce-Kelly): an edge that already agrees
+// with the order costs nothing, and one that does not only searches and
+// reorders the tasks placed between its two ends, which is also where a
+// cycle would have to be.
+class TaskDag {
+public:
+    TaskDag();
+
+    // Edges that would close a cycle are left out.
+    void reset(const QVector<TaskDependency> &edges);
+    // False, leaving the graph as it was, for a self-dependency or an edge
+    // that would close a cycle.
+    bool addDependency(int taskId, int dependsOn);
+    bool removeDependency(int taskId, int dependsOn);
+    void removeTask(int id);
+
+    bool hasDependency(int taskId, int dependsOn) const;
+    bool hasEdges(int id) const;
+    QVector<int> dependenciesOf(int id) const;
+    QVector<int> dependentsOf(int id) const;
+    // Every edge id is on, either end.
+    QVector<TaskDependency> edgesOf(int id) const;
+    int edgeCount() const { return m_edgeCount; }
+
+    // Tasks in the longest chain waiting on id, directly or not; 0 when
+    // nothing waits on it. A task always has a longer chain than any of
+    // its dependents, so sorting by it longest first is topological.
+    int chainLength(int id) const;
+    // Every task with an edge, each after all of its dependencies.
+    QVector<int> topologicalOrder() const;
+
+private:
+    struct Node {
+        int id;
+        QVector<int> dependencies;  // node indices
+        QVector<int> dependents;
+    };
+
+    QVector<Node> m_nodes;
+    QHash<int, int> m_indexById;
+    QVector<int> m_position;  // node -> place in the order
+    QVector<int> m_nodeAt;    // place in the order -> node
+    int m_edgeCount;
+    QVector<int> m_visited;
+    int m_visitStamp;
+    mutable QVector<int> m_chain;
+    mutable bool m_chainDirty;
+
+    int nodeFor(int id);
+    bool sortAll();
+    int nextStamp();
+    bool collectForward(int start, int upper, int target, QVector<int> &found);
+    void collectBackward(int start, int lower, QVector<int> &found);
+    void updateChains() const;
+};
+
+#endif // TASKDAG_H
@@ -0,0 +1,75 @@
+#include "taskdependencytracker.h"
+#include "taskstore.h"
+
+TaskDependencyTracker::TaskDependencyTracker(QObject *parent)
+    : QObject(parent), m_store(nullptr), m_dirty(false), m_needsRebuild(false)
+{
+}
+
+void TaskDependencyTracker::setStore(TaskStore *store)
+{
+    if (m_store)
+        disconnect(m_store, nullptr, this, nullptr);
+    m_store = store;
+    if (!m_store)
+        return;
+    connect(m_store, &TaskStore::tasksReset, this, &TaskDependencyTracker::markReset);
+    connect(m_store, &TaskStore::taskAdded, this, &TaskDependencyTracker::markChanged);
+    connect(m_store, &TaskStore::taskUpdated, this, &TaskDependencyTracker::markChanged);
+    connect(m_store, &TaskStore::taskRemoved, this, &TaskDependencyTracker::markRemoved);
+    connect(m_store, &TaskStore::tasksChanged, this, &TaskDependencyTracker::markBulk);
+    markReset();
+}
+
+const TaskDependencyGraph &TaskDependencyTracker::graph()
+{
+    if (!m_dirty)
+        return m_graph;
+
+    if (!m_store) {
+        m_graph = TaskDependencyGraph();
+    } else if (m_needsRebuild) {
+        m_graph = TaskDependencyGraph::build(m_store->tasks());
+    } else {
+        const QVector<Task> &tasks = m_store->tasks();
+        for (int id : m_changedIds) {
+            if (const Task *task = m_store->taskById(id))
+                m_graph.updateTask(*task, tasks);
+            else
+                m_graph.removeTask(id);
+        }
+    }
+    m_changedIds.clear();
+    m_dirty = false;
+    m_needsRebuild = false;
+    return m_graph;
+}
+
+void TaskDependencyTracker::markReset()
+{
+    m_changedIds.clear();
+    m_dirty = true;
+    m_needsRebuild = true;
+}
+
+void TaskDependencyTracker::markChanged(const Task &task)
+{
+    m_dirty = true;
+    if (!m_needsRebuild)
+        m_changedIds.insert(task.id);
+}
+
+void TaskDependencyTracker::markRemoved(int id)
+{
+    m_dirty = true;
+    if (!m_needsRebuild)
+        m_changedIds.insert(id);
+}
+
+void TaskDependencyTracker::markBulk(const QVector<Task> &changed, const QVector<int> &removed)
+{
+    for (const Task &task : changed)
+        markChanged(task);
+    for (int id : removed)
+        markRemoved(id);
+}
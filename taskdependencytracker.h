@@ -0,0 +1,39 @@
+#ifndef TASKDEPENDENCYTRACKER_H
+#define TASKDEPENDENCYTRACKER_H
+
+#include <QObject>
+#include <QSet>
+
+#include "task.h"
+#include "taskgraph.h"
+
+class TaskStore;
+
+// Keeps a TaskDependencyGraph in step with a TaskStore. Edits only mark
+// the graph dirty; graph() then patches in just the tasks that changed,
+// so whoever asks always sees a current graph. Only a reload of the whole
+// store builds it from scratch.
+class TaskDependencyTracker : public QObject {
+    Q_OBJECT
+
+public:
+    explicit TaskDependencyTracker(QObject *parent = nullptr);
+
+    void setStore(TaskStore *store);
+    const TaskDependencyGraph &graph();
+
+private slots:
+    void markReset();
+    void markChanged(const Task &task);
+    void markRemoved(int id);
+    void markBulk(const QVector<Task> &changed, const QVector<int> &removed);
+
+private:
+    TaskStore *m_store;
+    TaskDependencyGraph m_graph;
+    QSet<int> m_changedIds;
+    bool m_dirty;
+    bool m_needsRebuild;
+};
+
+#endif // TASKDEPENDENCYTRACKER_H
@@ -7,16 +7,17 @@ TaskDialog::TaskDialog(const QString &taskTitle,
                        const QString &dueDate,
                        int priority,
                        const QStringList &subTasks,
-                       const QString &status,
+                       TaskStatus status,
                        QWidget *parent)
     : QDialog(parent), m_result(TaskActionDialogResult::None), root(nullptr)
+    , dependencyEdit(nullptr), saveDependenciesBtn(nullptr)
 {
     setupUi(taskTitle, description, dueDate, priority, subTasks, status);
 }
 
 void TaskDialog::setupUi(const QString &taskTitle, const QString &description,
                          const QString &dueDate, int priority,
-                         const QStringList &subTasks, const QString &status)
+                         const QStringList &subTasks, TaskStatus status)
 {
     mainLayout = new QVBoxLayout(this);
 
@@ -27,7 +28,7 @@ void TaskDialog::setupUi(const QString &taskTitle, const QString &description,
         html += "<br>Description: " + description;
     if (priority > 0)
         html += "<br>Priority: " + QString::number(priority);
-    html += "<br>Status: " + status;
+    html += "<br>Status: " + taskStatusText(status);
     if (!subTasks.isEmpty())
         html += "<br><br><b>Check subtasks as you complete them.</b>";
 
@@ -60,9 +61,9 @@ void TaskDialog::setupUi(const QString &taskTitle, const QString &description,
     connect(deleteBtn, &QPushButton::clicked, this, &TaskDialog::onButtonClicked);
     connect(cancelBtn, &QPushButton::clicked, this, &TaskDialog::onButtonClicked);
 
-    if (status == "pending") pendingBtn->setDisabled(true);
-    if (status == "in progress") inProgressBtn->setDisabled(true);
-    if (status == "complete") completeBtn->setDisabled(true);
+    if (status == TaskStatus::Pending) pendingBtn->setDisabled(true);
+    if (status == TaskStatus::InProgress) inProgressBtn->setDisabled(true);
+    if (status == TaskStatus::Complete) completeBtn->setDisabled(true);
 
     completeBtn->setEnabled(areAllSubTasksCompleted());
 }
@@ -87,6 +88,54 @@ void TaskDialog::displaySubTaskTree(TreeNode* node, QVBoxLayout *layout)
     }
 }
 
+void TaskDialog::setDependencies(const QVector<QPair<int, QString>> &current,
+                                 const QVector<QPair<int, QString>> &suggested)
+{
+    QVBoxLayout *layout = new QVBoxLayout;
+    layout->addWidget(new QLabel("<br><b>Depends on</b>", this));
+    for (const QPair<int, QString> &task : current) {
+        QCheckBox *checkBox = new QCheckBox(QString("(%1) %2").arg(task.first).arg(task.second), this);
+        checkBox->setChecked(true);
+        dependencyBoxes.append(qMakePair(task.first, checkBox));
+        layout->addWidget(checkBox);
+    }
+    for (const QPair<int, QString> &task : suggested) {
+        QCheckBox *checkBox = new QCheckBox(QString("(%1) %2 - mentioned in this task").arg(task.first).arg(task.second), this);
+        dependencyBoxes.append(qMakePair(task.first, checkBox));
+        layout->addWidget(checkBox);
+    }
+
+    QHBoxLayout *addLayout = new QHBoxLayout;
+    dependencyEdit = new QLineEdit(this);
+    dependencyEdit->setPlaceholderText("Add task ids, separated by commas");
+    saveDependenciesBtn = new QPushButton("Save Dependencies", this);
+    connect(saveDependenciesBtn, &QPushButton::clicked, this, &TaskDialog::onButtonClicked);
+    addLayout->addWidget(dependencyEdit);
+    addLayout->addWidget(saveDependenciesBtn);
+    layout->addLayout(addLayout);
+
+    // Above the row of action buttons.
+    mainLayout->insertLayout(mainLayout->count() - 1, layout);
+}
+
+QVector<int> TaskDialog::selectedDependencies() const
+{
+    QVector<int> ids;
+    for (const QPair<int, QCheckBox*> &box : dependencyBoxes) {
+        if (box.second->isChecked() && !ids.contains(box.first))
+            ids.append(box.first);
+    }
+    if (dependencyEdit) {
+        for (const QString &part : dependencyEdit->text().split(",", Qt::SkipEmptyParts)) {
+            bool ok = false;
+            int id = part.trimmed().toInt(&ok);
+            if (ok && !ids.contains(id))
+                ids.append(id);
+        }
+    }
+    return ids;
+}
+
 bool TaskDialog::areAllSubTasksCompleted() const
 {
     for (QCheckBox* cb : checkBoxes) {
@@ -116,6 +165,8 @@ void TaskDialog::onButtonClicked()
         m_result = TaskActionDialogResult::SetToComplete;
     } else if (btn == deleteBtn) {
         m_result = TaskActionDialogResult::Delete;
+    } else if (btn == saveDependenciesBtn) {
+        m_result = TaskActionDialogResult::SaveDependencies;
     } else {
         m_result = TaskActionDialogResult::None;
     }
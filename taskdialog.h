@@ -7,13 +7,18 @@
 #include <QVBoxLayout>
 #include <QCheckBox>
 #include <QLabel>
+#include <QLineEdit>
+#include <QPair>
+
+#include "task.h"
 
 enum class TaskActionDialogResult {
     None,
     SetToPending,
     SetToInProgress,
     SetToComplete,
-    Delete
+    Delete,
+    SaveDependencies
 };
 
 struct TreeNode {
@@ -42,11 +47,17 @@ public:
                const QString &dueDate,
                int priority,
                const QStringList &subTasks,
-               const QString &status,
+               TaskStatus status,
                QWidget *parent = nullptr);
 
     TaskActionDialogResult result() const { return m_result; }
 
+    // Lists the task's dependencies, checked, and suggestions, unchecked,
+    // as (id, title) pairs, with a field for adding more by id.
+    void setDependencies(const QVector<QPair<int, QString>> &current,
+                         const QVector<QPair<int, QString>> &suggested);
+    QVector<int> selectedDependencies() const;
+
 private slots:
     void onSubtaskToggled(bool);
     void onButtonClicked();
@@ -56,9 +67,12 @@ private:
     TreeNode* root;
     QVector<QCheckBox*> checkBoxes;
     QPushButton *pendingBtn, *inProgressBtn, *completeBtn, *deleteBtn, *cancelBtn;
+    QVector<QPair<int, QCheckBox*>> dependencyBoxes;
+    QLineEdit *dependencyEdit;
+    QPushButton *saveDependenciesBtn;
     QVBoxLayout *mainLayout;
 
-    void setupUi(const QString &taskTitle, const QString &description, const QString &dueDate, int priority, const QStringList &subTasks, const QString &status);
+    void setupUi(const QString &taskTitle, const QString &description, const QString &dueDate, int priority, const QStringList &subTasks, TaskStatus status);
     void buildSubTaskTree(const QStringList &subTasks);
     void displaySubTaskTree(TreeNode* node, QVBoxLayout *layout);
     bool areAllSubTasksCompleted() const;
@@ -0,0 +1,147 @@
+#include "taskexporter.h"
+#include "taskrepository.h"
+#include <QSaveFile>
+
+void appendJsonString(QByteArray &out, const QString &text)
+{
+    static const char hex[] = "0123456789abcdef";
+    const QByteArray utf8 = text.toUtf8();
+    out += '"';
+    for (char ch : utf8) {
+        uchar c = uchar(ch);
+        switch (c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\b': out += "\\b"; break;
+        case '\f': out += "\\f"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (c < 0x20) {
+                out += "\\u00";
+                out += hex[c >> 4];
+                out += hex[c & 0xF];
+            } else {
+                out += ch;
+            }
+        }
+    }
+    out += '"';
+}
+
+void appendTaskJson(QByteArray &out, const Task &task, int indent)
+{
+    const bool pretty = indent >= 0;
+    bool first = true;
+    auto key = [&](const char *name) {
+        if (!first)
+            out += ',';
+        first = false;
+        if (pretty) {
+            out += '\n';
+            out.append(indent + 2, ' ');
+        }
+        out += '"';
+        out += name;
+        out += pretty ? "\": " : "\":";
+    };
+
+    if (pretty)
+        out.append(indent, ' ');
+    out += '{';
+    key("id");
+    out += QByteArray::number(task.id);
+    key("title");
+    appendJsonString(out, task.title);
+    key("description");
+    appendJsonString(out, task.description);
+    key("dueDate");
+    appendJsonString(out, dueDayText(task.dueDay));
+    key("priority");
+    out += QByteArray::number(task.priority);
+    key("status");
+    appendJsonString(out, taskStatusText(task.status));
+    key("subtasks");
+    appendJsonString(out, joinSubTasks(task.subTasks));
+    if (pretty) {
+        out += '\n';
+        out.append(indent, ' ');
+    }
+    out += '}';
+}
+
+TaskExporter::TaskExporter(TaskRepository &repo)
+    : m_repo(repo), m_device(nullptr), m_written(0), m_cancelled(false)
+{
+}
+
+bool TaskExporter::exportFile(const QString &path, const Progress &progress)
+{
+    m_written = 0;
+    m_cancelled = false;
+    m_error.clear();
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return fail("Could not open file for writing.");
+    m_device = &file;
+    m_buffer.clear();
+    m_buffer.reserve(kBufferSize + 4096);
+
+    const int total = m_repo.countTasks();
+    m_buffer += "{\n  \"tasks\": [\n";
+    bool ok = m_repo.forEachTask([&](const Task &task) {
+        if (m_written > 0)
+            m_buffer += ",\n";
+        writeTask(task);
+        ++m_written;
+        if (m_buffer.size() >= kBufferSize && !flush())
+            return false;
+        if (progress && m_written % kProgressInterval == 0 && !progress(m_written, total)) {
+            m_cancelled = true;
+            fail("Export cancelled.");
+            return false;
+        }
+        return true;
+    });
+    if (!ok)
+        fail(m_repo.lastError());
+
+    if (ok && m_error.isEmpty()) {
+        m_buffer += m_written > 0 ? "\n  ]\n}\n" : "  ]\n}\n";
+        if (flush() && !file.commit())
+            fail(file.errorString());
+    }
+    m_device = nullptr;
+    m_buffer.clear();
+    if (!m_error.isEmpty()) {
+        file.cancelWriting();
+        return false;
+    }
+    if (progress)
+        progress(m_written, m_written);
+    return true;
+}
+
+void TaskExporter::writeTask(const Task &task)
+{
+    appendTaskJson(m_buffer, task, 4);
+}
+
+bool TaskExporter::flush()
+{
+    if (m_buffer.isEmpty())
+        return true;
+    if (m_device->write(m_buffer) != m_buffer.size())
+        return fail(m_device->errorString());
+    m_buffer.resize(0);
+    return true;
+}
+
+bool TaskExporter::fail(const QString &message)
+{
+    if (m_error.isEmpty())
+        m_error = message;
+    return false;
+}
@@ -0,0 +1,53 @@
+#ifndef TASKEXPORTER_H
+#define TASKEXPORTER_H
+
+#include <QByteArray>
+#include <QString>
+#include <functional>
+
+#include "task.h"
+
+class QIODevice;
+class TaskRepository;
+
+// Appends text as a quoted JSON string, escaping quotes, backslashes and
+// every control character.
+void appendJsonString(QByteArray &out, const QString &text);
+// Appends task as a JSON object with the export's field names: on one
+// line, or with indent >= 0 one field per line, the braces indented by
+// indent spaces and the fields by two more.
+void appendTaskJson(QByteArray &out, const Task &task, int indent = -1);
+
+// Writes every task as {"tasks": [...]} straight from a forward-only
+// cursor through a fixed-size buffer, so memory stays flat however many
+// tasks there are. The file is replaced only once the export completes.
+class TaskExporter {
+public:
+    // Called every kProgressInterval tasks; return false to cancel.
+    using Progress = std::function<bool(int written, int total)>;
+
+    explicit TaskExporter(TaskRepository &repo);
+
+    bool exportFile(const QString &path, const Progress &progress = Progress());
+
+    int exportedCount() const { return m_written; }
+    bool wasCancelled() const { return m_cancelled; }
+    QString errorString() const { return m_error; }
+
+    static const int kBufferSize = 1 << 16;
+    static const int kProgressInterval = 4096;
+
+private:
+    TaskRepository &m_repo;
+    QIODevice *m_device;
+    QByteArray m_buffer;
+    int m_written;
+    bool m_cancelled;
+    QString m_error;
+
+    void writeTask(const Task &task);
+    bool flush();
+    bool fail(const QString &message);
+};
+
+#endif // TASKEXPORTER_H
@@ -0,0 +1,363 @@
+#include "taskgraph.h"
+#include <QPair>
+#include <QSet>
+#include <algorithm>
+
+namespace {
+
+// Titles added since the matcher was built are scanned for one by one;
+// past this many the matcher is rebuilt instead.
+const int kMaxExtraTitles = 64;
+// Patched or dropped rows tolerated before the rows are packed again.
+const int kMinCompactRows = 1024;
+
+void insertSorted(QVector<int> &row, int id)
+{
+    auto it = std::lower_bound(row.begin(), row.end(), id);
+    if (it == row.end() || *it != id)
+        row.insert(it, id);
+}
+
+void removeSorted(QVector<int> &row, int id)
+{
+    auto it = std::lower_bound(row.begin(), row.end(), id);
+    if (it != row.end() && *it == id)
+        row.erase(it);
+}
+
+}
+
+TitleMatcher::TitleMatcher()
+    : m_fail(1, 0), m_outputLink(1, 0), m_titleIndex(1, -1), m_stamp(0)
+{
+}
+
+void TitleMatcher::build(const QVector<QString> &titles)
+{
+    m_children.clear();
+    m_fail = QVector<int>(1, 0);
+    m_outputLink = QVector<int>(1, 0);
+    m_titleIndex = QVector<int>(1, -1);
+    QVector<QVector<QPair<ushort, int>>> edges(1);
+
+    for (int i = 0; i < titles.size(); ++i) {
+        const QString &title = titles[i];
+        if (title.isEmpty())
+            continue;
+        int node = 0;
+        for (QChar ch : title) {
+            const ushort c = ch.unicode();
+            int next = child(node, c);
+            if (next == -1) {
+                next = m_titleIndex.size();
+                m_children.insert((quint64(node) << 16) | c, next);
+                edges[node].push_back(qMakePair(c, next));
+                edges.push_back(QVector<QPair<ushort, int>>());
+                m_titleIndex.push_back(-1);
+            }
+            node = next;
+        }
+        m_titleIndex[node] = i;
+    }
+
+    // Breadth-first, so every failure target is finished before it is used.
+    const int nodeCount = m_titleIndex.size();
+    m_fail.fill(0, nodeCount);
+    m_outputLink.fill(0, nodeCount);
+    QVector<int> queue;
+    queue.reserve(nodeCount);
+    queue.push_back(0);
+    for (int head = 0; head < queue.size(); ++head) {
+        const int node = queue[head];
+        for (const QPair<ushort, int> &edge : edges[node]) {
+            const int next = edge.second;
+            if (node != 0) {
+                int f = m_fail[node];
+                int target = child(f, edge.first);
+                while (target == -1 && f != 0) {
+                    f = m_fail[f];
+                    target = child(f, edge.first);
+                }
+                m_fail[next] = target == -1 ? 0 : target;
+            }
+            const int fail = m_fail[next];
+            m_outputLink[next] = m_titleIndex[fail] != -1 ? fail : m_outputLink[fail];
+            queue.push_back(next);
+        }
+    }
+
+    m_seen.fill(0, nodeCount);
+    m_stamp = 0;
+}
+
+TaskDependencyGraph::Range TaskDependencyGraph::dependenciesOf(int id) const
+{
+    auto patched = m_patched.constFind(id);
+    if (patched != m_patched.constEnd())
+        return Range{patched->constData(), patched->constData() + patched->size()};
+    const int row = m_rowById.value(id, -1);
+    if (row == -1)
+        return Range{nullptr, nullptr};
+    const int *targets = m_targets.constData();
+    return Range{targets + m_offsets[row], targets + m_offsets[row + 1]};
+}
+
+TaskDependencyGraph TaskDependencyGraph::build(const QVector<Task> &tasks)
+{
+    TaskDependencyGraph graph;
+    graph.m_titleById.reserve(tasks.size());
+    graph.m_descriptionById.reserve(tasks.size());
+    for (const Task &t : tasks) {
+        const QString title = t.title.toLower();
+        graph.m_titleById.insert(t.id, title);
+        graph.m_descriptionById.insert(t.id, t.description);
+        if (!title.isEmpty())
+            graph.m_idsByTitle[title].push_back(t.id);
+    }
+    graph.rebuildMatcher();
+
+    graph.m_rowById.reserve(tasks.size());
+    graph.m_offsets.reserve(tasks.size() + 1);
+    graph.m_offsets.push_back(0);
+    for (const Task &t : tasks) {
+        const QVector<int> deps = graph.findDependencies(t);
+        for (int dep : deps)
+            graph.m_dependents[dep].push_back(t.id);
+        graph.m_rowById.insert(t.id, graph.m_offsets.size() - 1);
+        graph.m_targets += deps;
+        graph.m_offsets.push_back(graph.m_targets.size());
+    }
+    return graph;
+}
+
+void TaskDependencyGraph::insertTask(const Task &task, const QVector<Task> &tasks)
+{
+    if (contains(task.id)) {
+        updateTask(task, tasks);
+        return;
+    }
+
+    // Tasks that already mention the title. Another task with the same
+    // title has exactly those as dependents; namesakes never depend on
+    // each other.
+    const QString title = task.title.toLower();
+    QVector<int> dependents;
+    if (!title.isEmpty()) {
+        const QVector<int> namesakes = m_idsByTitle.value(title);
+        if (!namesakes.isEmpty()) {
+            dependents = m_dependents.value(namesakes.first());
+        } else {
+            // Lowercased like TitleMatcher's input, not case-folded, so both
+            // paths agree on non-ASCII titles.
+            for (const Task &t : tasks) {
+                if (t.id != task.id && contains(t.id)
+                    && (t.title.toLower().contains(title) || t.description.toLower().contains(title)))
+                    dependents.push_back(t.id);
+            }
+        }
+        if (!m_idsByTitle.contains(title))
+            m_extraTitles.push_back(title);
+        m_idsByTitle[title].push_back(task.id);
+    }
+    m_titleById.insert(task.id, title);
+    m_descriptionById.insert(task.id, task.description);
+
+    setRow(task.id, findDependencies(task));
+    QVector<int> &reverse = m_dependents[task.id];
+    for (int id : dependents) {
+        if (id == task.id || reverse.contains(id))
+            continue;
+        insertSorted(mutableRow(id), task.id);
+        reverse.push_back(id);
+    }
+    if (reverse.isEmpty())
+        m_dependents.remove(task.id);
+
+    if (m_extraTitles.size() > kMaxExtraTitles)
+        rebuildMatcher();
+    compactIfNeeded();
+}
+
+void TaskDependencyGraph::updateTask(const Task &task, const QVector<Task> &tasks)
+{
+    auto title = m_titleById.constFind(task.id);
+    if (title == m_titleById.constEnd()) {
+        insertTask(task, tasks);
+        return;
+    }
+    // A new title changes who depends on the task; a new description only
+    // changes what the task depends on. Anything else touches no edge.
+    if (*title != task.title.toLower()) {
+        removeTask(task.id);
+        insertTask(task, tasks);
+        return;
+    }
+    QString &description = m_descriptionById[task.id];
+    if (description == task.description)
+        return;
+    description = task.description;
+    setRow(task.id, findDependencies(task));
+    compactIfNeeded();
+}
+
+void TaskDependencyGraph::removeTask(int id)
+{
+    auto title = m_titleById.find(id);
+    if (title == m_titleById.end())
+        return;
+
+    for (int dependent : m_dependents.take(id))
+        removeSorted(mutableRow(dependent), id);
+    setRow(id, QVector<int>());
+    m_patched.remove(id);
+    m_rowById.remove(id);
+
+    // The title stays a key, even with no owner left, while the matcher
+    // still knows it.
+    if (!title->isEmpty())
+        m_idsByTitle[*title].removeOne(id);
+    m_titleById.erase(title);
+    m_descriptionById.remove(id);
+    compactIfNeeded();
+}
+
+QVector<int> TaskDependencyGraph::findDependencies(const Task &task) const
+{
+    // A task always matches its own title; that names itself and its
+    // namesakes, none of which it depends on.
+    const QString ownTitle = task.title.toLower();
+    QVector<int> deps;
+    auto addTitle = [this, &deps, &ownTitle](const QString &title) {
+        if (title == ownTitle)
+            return;
+        deps += m_idsByTitle.value(title);
+    };
+    auto found = [this, &addTitle](int index) { addTitle(m_matcherTitles[index]); };
+    m_matcher.match(task.description, found);
+    m_matcher.match(task.title, found);
+    if (!m_extraTitles.isEmpty()) {
+        const QString description = task.description.toLower();
+        for (const QString &title : m_extraTitles) {
+            if (description.contains(title) || ownTitle.contains(title))
+                addTitle(title);
+        }
+    }
+    std::sort(deps.begin(), deps.end());
+    deps.erase(std::unique(deps.begin(), deps.end()), deps.end());
+    return deps;
+}
+
+QVector<int> &TaskDependencyGraph::mutableRow(int id)
+{
+    auto patched = m_patched.find(id);
+    if (patched == m_patched.end()) {
+        const Range row = dependenciesOf(id);
+        patched = m_patched.insert(id, QVector<int>(row.begin(), row.end()));
+    }
+    return *patched;
+}
+
+void TaskDependencyGraph::setRow(int id, const QVector<int> &deps)
+{
+    for (int dep : dependenciesOf(id)) {
+        auto reverse = m_dependents.find(dep);
+        if (reverse == m_dependents.end())
+            continue;
+        reverse->removeOne(id);
+        if (reverse->isEmpty())
+            m_dependents.erase(reverse);
+    }
+    for (int dep : deps)
+        m_dependents[dep].push_back(id);
+    m_patched.insert(id, deps);
+}
+
+void TaskDependencyGraph::rebuildMatcher()
+{
+    m_matcherTitles.clear();
+    for (auto it = m_idsByTitle.begin(); it != m_idsByTitle.end();) {
+        if (it->isEmpty()) {
+            it = m_idsByTitle.erase(it);
+        } else {
+            m_matcherTitles.push_back(it.key());
+            ++it;
+        }
+    }
+    m_matcher.build(m_matcherTitles);
+    m_extraTitles.clear();
+}
+
+void TaskDependencyGraph::compactIfNeeded()
+{
+    const int dropped = m_offsets.size() - 1 - m_rowById.size();
+    if (m_patched.size() + dropped <= qMax(kMinCompactRows, size() / 4))
+        return;
+
+    QHash<int, int> rowById;
+    QVector<int> offsets;
+    QVector<int> targets;
+    rowById.reserve(size());
+    offsets.reserve(size() + 1);
+    offsets.push_back(0);
+    for (auto it = m_titleById.cbegin(); it != m_titleById.cend(); ++it) {
+        for (int dep : dependenciesOf(it.key()))
+            targets.push_back(dep);
+        rowById.insert(it.key(), offsets.size() - 1);
+        offsets.push_back(targets.size());
+    }
+    m_rowById.swap(rowById);
+    m_offsets.swap(offsets);
+    m_targets.swap(targets);
+    m_patched.clear();
+}
+
+TaskDependencyGraph buildTaskDependencyGraph(const QVector<Task> &tasks)
+{
+    return TaskDependencyGraph::build(tasks);
+}
+
+QVector<Task> recommendTasks(const QVector<Task> &tasks, const TaskDependencyGraph &graph, int maxRecs)
+{
+    QSet<int> completed;
+    for (const Task& t : tasks) {
+        if (t.status == TaskStatus::Complete)
+            completed.insert(t.id);
+    }
+
+    // Rank by index and only order the top.
+    struct Candidate {
+        int priority;
+        qint32 dueDay;
+        int id;
+        int index;
+    };
+    QVector<Candidate> candidates;
+    for (int i = 0; i < tasks.size(); ++i) {
+        const Task &t = tasks[i];
+        if (t.status == TaskStatus::Complete) continue;
+        bool allDepsDone = true;
+        for (int dep : graph.dependenciesOf(t.id)) {
+            if (!completed.contains(dep)) {
+                allDepsDone = false;
+                break;
+            }
+        }
+        if (allDepsDone)
+            candidates.push_back(Candidate{t.priority, t.dueDay, t.id, i});
+    }
+    const int count = qMin(maxRecs, candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(),
+                      [](const Candidate &a, const Candidate &b) {
+        if (a.priority != b.priority)
+            return a.priority > b.priority;
+        if (a.dueDay != b.dueDay)
+            return a.dueDay < b.dueDay;
+        return a.id < b.id;
+    });
+
+    QVector<Task> recs;
+    recs.reserve(count);
+    for (int i = 0; i < count; ++i)
+        recs.push_back(tasks[candidates[i].index]);
+    return recs;
+}
@@ -0,0 +1,128 @@
+#ifndef TASKGRAPH_H
+#define TASKGRAPH_H
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+#include "task.h"
+
+// Aho-Corasick automaton over a set of lowercased titles. One pass over a
+// text reports every title it contains, however many titles there are.
+class TitleMatcher {
+public:
+    TitleMatcher();
+
+    // titles must be lowercased; empty ones are ignored.
+    void build(const QVector<QString> &titles);
+
+    // Calls found(titleIndex) once per distinct title occurring in text.
+    template <typename Found>
+    void match(const QString &text, Found found) const;
+
+    bool isEmpty() const { return m_titleIndex.size() <= 1; }
+
+private:
+    // Node 0 is the root. Children are keyed by (node << 16) | char.
+    QHash<quint64, int> m_children;
+    QVector<int> m_fail;
+    QVector<int> m_outputLink;  // nearest suffix node that ends a title
+    QVector<int> m_titleIndex;  // title ending here, or -1
+    mutable QVector<int> m_seen;
+    mutable int m_stamp;
+
+    int child(int node, ushort c) const { return m_children.value((quint64(node) << 16) | c, -1); }
+};
+
+// Task id -> ids of the tasks it depends on. A task depends on every other
+// task whose title (compared case-insensitively) appears in its own title
+// or description; tasks sharing a title are all depended on, though never
+// by each other.
+//
+// Rows live in compressed sparse row form: the dependencies of the task
+// at row r are m_targets[m_offsets[r] .. m_offsets[r + 1]). Edits after
+// build() only touch the rows of the tasks involved, kept as patch rows
+// until enough pile up to pack them again.
+class TaskDependencyGraph {
+public:
+    struct Range {
+        const int *first;
+        const int *last;
+        const int *begin() const { return first; }
+        const int *end() const { return last; }
+        int size() const { return int(last - first); }
+        bool isEmpty() const { return first == last; }
+    };
+
+    int size() const { return m_titleById.size(); }
+    bool isEmpty() const { return m_titleById.isEmpty(); }
+    bool contains(int id) const { return m_titleById.contains(id); }
+    Range dependenciesOf(int id) const;
+
+    static TaskDependencyGraph build(const QVector<Task> &tasks);
+
+    // Incremental maintenance. tasks is the full current task list, used
+    // to find the tasks that mention a newly added title.
+    void insertTask(const Task &task, const QVector<Task> &tasks);
+    void updateTask(const Task &task, const QVector<Task> &tasks);
+    void removeTask(int id);
+
+private:
+    QHash<int, int> m_rowById;
+    QVector<int> m_offsets;
+    QVector<int> m_targets;
+    QHash<int, QVector<int>> m_patched;
+    QHash<int, QVector<int>> m_dependents;  // reverse edges
+
+    QHash<int, QString> m_titleById;
+    QHash<int, QString> m_descriptionById;
+    QHash<QString, QVector<int>> m_idsByTitle;
+    TitleMatcher m_matcher;
+    QVector<QString> m_matcherTitles;
+    QVector<QString> m_extraTitles;  // added since the matcher was built
+
+    QVector<int> findDependencies(const Task &task) const;
+    QVector<int> &mutableRow(int id);
+    void setRow(int id, const QVector<int> &deps);
+    void rebuildMatcher();
+    void compactIfNeeded();
+};
+
+TaskDependencyGraph buildTaskDependencyGraph(const QVector<Task> &tasks);
+
+// Open tasks whose dependencies are all complete, highest priority first,
+// then earliest due date.
+QVector<Task> recommendTasks(const QVector<Task> &tasks, const TaskDependencyGraph &graph, int maxRecs = 5);
+
+template <typename Found>
+void TitleMatcher::match(const QString &text, Found found) const
+{
+    if (isEmpty())
+        return;
+    // Each node's outputs are reported at most once per call; a node seen
+    // before means its whole output chain was reported with it.
+    if (++m_stamp == 0) {
+        m_seen.fill(0);
+        m_stamp = 1;
+    }
+    const QString lower = text.toLower();
+    int state = 0;
+    for (QChar ch : lower) {
+        const ushort c = ch.unicode();
+        int next = child(state, c);
+        while (next == -1 && state != 0) {
+            state = m_fail[state];
+            next = child(state, c);
+        }
+        state = next == -1 ? 0 : next;
+
+        for (int node = m_titleIndex[state] != -1 ? state : m_outputLink[state];
+             node > 0 && m_seen[node] != m_stamp;
+             node = m_outputLink[node]) {
+            m_seen[node] = m_stamp;
+            found(m_titleIndex[node]);
+        }
+    }
+}
+
+#endif // TASKGRAPH_H
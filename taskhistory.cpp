@@ -0,0 +1,361 @@
+#include "taskhistory.h"
+#include "taskstore.h"
+
+#include <QHash>
+#include <QSet>
+#include <utility>
+
+static quint8 changedFields(const Task &a, const Task &b)
+{
+    quint8 fields = 0;
+    if (a.title != b.title)
+        fields |= TaskAction::Title;
+    if (a.description != b.description)
+        fields |= TaskAction::Description;
+    if (a.dueDay != b.dueDay)
+        fields |= TaskAction::DueDay;
+    if (a.subTasks != b.subTasks)
+        fields |= TaskAction::SubTasks;
+    if (a.priority != b.priority)
+        fields |= TaskAction::Priority;
+    if (a.status != b.status)
+        fields |= TaskAction::Status;
+    return fields;
+}
+
+// The id and the fields in mask; the rest stay empty and cost nothing.
+static Task maskedCopy(const Task &task, quint8 fields)
+{
+    Task copy = {};
+    copy.id = task.id;
+    copy.dueDay = kNoDueDay;
+    if (fields & TaskAction::Title)
+        copy.title = task.title;
+    if (fields & TaskAction::Description)
+        copy.description = task.description;
+    if (fields & TaskAction::DueDay)
+        copy.dueDay = task.dueDay;
+    if (fields & TaskAction::SubTasks)
+        copy.subTasks = task.subTasks;
+    if (fields & TaskAction::Priority)
+        copy.priority = task.priority;
+    if (fields & TaskAction::Status)
+        copy.status = task.status;
+    return copy;
+}
+
+static void swapFields(Task &a, Task &b, quint8 fields)
+{
+    if (fields & TaskAction::Title)
+        a.title.swap(b.title);
+    if (fields & TaskAction::Description)
+        a.description.swap(b.description);
+    if (fields & TaskAction::DueDay)
+        std::swap(a.dueDay, b.dueDay);
+    if (fields & TaskAction::SubTasks)
+        a.subTasks.swap(b.subTasks);
+    if (fields & TaskAction::Priority)
+        std::swap(a.priority, b.priority);
+    if (fields & TaskAction::Status)
+        std::swap(a.status, b.status);
+}
+
+TaskHistory::TaskHistory(TaskStore *store, qint64 byteBudget)
+    : m_store(store)
+    , m_byteBudget(byteBudget)
+    , m_bytes(0)
+    , m_undoSteps(0)
+    , m_groupDepth(0)
+    , m_groupStarted(false)
+{
+}
+
+qint64 TaskHistory::cost(const TaskAction &action)
+{
+    // Shared strings are counted in full; the store's copy may change.
+    qint64 bytes = sizeof(TaskAction);
+    if (action.fields & TaskAction::Title)
+        bytes += action.task.title.size() * qint64(sizeof(QChar));
+    if (action.fields & TaskAction::Description)
+        bytes += action.task.description.size() * qint64(sizeof(QChar));
+    if (action.fields & TaskAction::SubTasks) {
+        for (const QString &subTask : action.task.subTasks)
+            bytes += sizeof(QString) + subTask.size() * qint64(sizeof(QChar));
+    }
+    bytes += action.edges.size() * qint64(sizeof(TaskDependency));
+    return bytes;
+}
+
+bool TaskHistory::updateTask(const Task &task)
+{
+    const Task *current = m_store->taskById(task.id);
+    if (!current)
+        return false;
+    const quint8 fields = changedFields(*current, task);
+    if (!fields)
+        return true;
+    record({maskedCopy(*current, fields), TaskActionType::Update, fields, false});
+    return m_store->updateTask(task);
+}
+
+bool TaskHistory::setStatus(int id, TaskStatus status)
+{
+    const Task *current = m_store->taskById(id);
+    if (!current)
+        return false;
+    if (current->status == status)
+        return true;
+    record({maskedCopy(*current, TaskAction::Status), TaskActionType::Update, TaskAction::Status, false});
+    return m_store->setStatus(id, status);
+}
+
+bool TaskHistory::removeTask(int id)
+{
+    const Task *current = m_store->taskById(id);
+    if (!current)
+        return false;
+    record({*current, TaskActionType::Delete, TaskAction::AllFields, false, m_store->dependencies().edgesOf(id)});
+    return m_store->removeTask(id);
+}
+
+int TaskHistory::setStatuses(const QVector<int> &ids, TaskStatus status)
+{
+    QVector<int> changing;
+    QSet<int> seen;
+    beginGroup();
+    for (int id : ids) {
+        const Task *current = m_store->taskById(id);
+        if (!current || current->status == status || seen.contains(id))
+            continue;
+        seen.insert(id);
+        record({maskedCopy(*current, TaskAction::Status), TaskActionType::Update, TaskAction::Status, false});
+        changing.push_back(id);
+    }
+    endGroup();
+    return changing.isEmpty() ? 0 : m_store->setStatuses(changing, status);
+}
+
+int TaskHistory::removeTasks(const QVector<int> &ids)
+{
+    QVector<int> removing;
+    QSet<int> seen;
+    beginGroup();
+    for (int id : ids) {
+        const Task *current = m_store->taskById(id);
+        if (!current || seen.contains(id))
+            continue;
+        seen.insert(id);
+        record({*current, TaskActionType::Delete, TaskAction::AllFields, false, m_store->dependencies().edgesOf(id)});
+        removing.push_back(id);
+    }
+    endGroup();
+    return removing.isEmpty() ? 0 : m_store->removeTasks(removing);
+}
+
+void TaskHistory::beginGroup()
+{
+    if (m_groupDepth++ == 0)
+        m_groupStarted = false;
+}
+
+void TaskHistory::endGroup()
+{
+    if (m_groupDepth > 0 && --m_groupDepth == 0)
+        m_groupStarted = false;
+}
+
+void TaskHistory::record(TaskAction action)
+{
+    clearRedo();
+    action.joined = m_groupDepth > 0 && m_groupStarted;
+    if (m_groupDepth > 0)
+        m_groupStarted = true;
+    if (!action.joined)
+        ++m_undoSteps;
+    m_bytes += cost(action);
+    m_undo.enqueue(std::move(action));
+    trim();
+}
+
+void TaskHistory::apply(TaskAction &action, bool undoing)
+{
+    if (action.type == TaskActionType::Delete) {
+        if (undoing) {
+            m_store->restoreTask(action.task, action.edges);
+        } else {
+            // Edges may have changed since; take the ones it has now.
+            action.edges = m_store->dependencies().edgesOf(action.task.id);
+            m_store->removeTask(action.task.id);
+        }
+        return;
+    }
+
+    const Task *current = m_store->taskById(action.task.id);
+    if (!current)
+        return;
+    if (action.fields == TaskAction::Status) {
+        const TaskStatus status = action.task.status;
+        action.task.status = current->status;
+        m_store->setStatus(action.task.id, status);
+        return;
+    }
+    Task next = *current;
+    swapFields(next, action.task, action.fields);
+    m_store->updateTask(next);
+}
+
+void TaskHistory::applyStep(QVector<TaskAction> &step, bool undoing)
+{
+    for (const TaskAction &action : step)
+        m_bytes -= cost(action);
+
+    // Actions on distinct tasks commute, so a step that touches each task
+    // once goes to the store as bulk edits. Anything else replays in order.
+    QSet<int> ids;
+    for (const TaskAction &action : step)
+        ids.insert(action.task.id);
+    if (step.size() == 1 || ids.size() != step.size()) {
+        for (TaskAction &action : step)
+            apply(action, undoing);
+    } else {
+        QVector<Task> restored;
+        QVector<TaskDependency> restoredEdges;
+        QVector<int> removed;
+        QHash<int, QVector<int>> byStatus;
+        for (TaskAction &action : step) {
+            if (action.type == TaskActionType::Delete) {
+                if (undoing) {
+                    restored.push_back(action.task);
+                    restoredEdges += action.edges;
+                } else {
+                    action.edges = m_store->dependencies().edgesOf(action.task.id);
+                    removed.push_back(action.task.id);
+                }
+                continue;
+            }
+            const Task *current = m_store->taskById(action.task.id);
+            if (!current || action.fields != TaskAction::Status) {
+                apply(action, undoing);
+                continue;
+            }
+            const TaskStatus status = action.task.status;
+            action.task.status = current->status;
+            byStatus[int(status)].push_back(action.task.id);
+        }
+        if (!restored.isEmpty())
+            m_store->restoreTasks(restored, restoredEdges);
+        if (!removed.isEmpty())
+            m_store->removeTasks(removed);
+        for (auto it = byStatus.cbegin(); it != byStatus.cend(); ++it)
+            m_store->setStatuses(it.value(), TaskStatus(it.key()));
+    }
+
+    for (const TaskAction &action : step)
+        m_bytes += cost(action);
+}
+
+bool TaskHistory::undo()
+{
+    if (m_undo.isEmpty())
+        return false;
+    QVector<TaskAction> step;
+    bool joined = true;
+    while (joined && !m_undo.isEmpty()) {
+        step.push_back(m_undo.takeLast());
+        joined = step.last().joined;
+    }
+    --m_undoSteps;
+    applyStep(step, true);
+    for (TaskAction &action : step)
+        m_redo.push_back(std::move(action));
+    return true;
+}
+
+bool TaskHistory::redo()
+{
+    if (m_redo.isEmpty())
+        return false;
+    QVector<TaskAction> step;
+    do {
+        step.push_back(m_redo.takeLast());
+        if (!step.last().joined)
+            ++m_undoSteps;
+    } while (!m_redo.isEmpty() && m_redo.last().joined);
+    applyStep(step, false);
+    for (TaskAction &action : step)
+        m_undo.enqueue(std::move(action));
+    trim();
+    return true;
+}
+
+void TaskHistory::clearRedo()
+{
+    for (int i = 0; i < m_redo.size(); ++i)
+        m_bytes -= cost(m_redo.at(i));
+    m_redo.clear();
+}
+
+void TaskHistory::trim()
+{
+    // The newest step is kept even when it alone is over budget.
+    while (m_bytes > m_byteBudget && m_undoSteps > 1) {
+        do {
+            m_bytes -= cost(m_undo.front());
+            m_undo.dequeue();
+        } while (!m_undo.isEmpty() && m_undo.front().joined);
+        --m_undoSteps;
+    }
+}
+
+void TaskHistory::setByteBudget(qint64 bytes)
+{
+    m_byteBudget = bytes;
+    trim();
+}
+
+void TaskHistory::clear()
+{
+    m_undo.clear();
+    m_redo.clear();
+    m_bytes = 0;
+    m_undoSteps = 0;
+    m_groupStarted = false;
+}
+
+QVector<TaskAction> TaskHistory::undoActions() const
+{
+    QVector<TaskAction> actions;
+    actions.reserve(m_undo.size());
+    for (int i = 0; i < m_undo.size(); ++i)
+        actions.push_back(m_undo.at(i));
+    return actions;
+}
+
+QVector<TaskAction> TaskHistory::redoActions() const
+{
+    QVector<TaskAction> actions;
+    actions.reserve(m_redo.size());
+    for (int i = 0; i < m_redo.size(); ++i)
+        actions.push_back(m_redo.at(i));
+    return actions;
+}
+
+bool TaskHistory::restore(const QVector<TaskAction> &undo, const QVector<TaskAction> &redo)
+{
+    if (canUndo() || canRedo())
+        return false;
+    for (TaskAction action : undo) {
+        if (m_undo.isEmpty())
+            action.joined = false;
+        if (!action.joined)
+            ++m_undoSteps;
+        m_bytes += cost(action);
+        m_undo.enqueue(std::move(action));
+    }
+    for (const TaskAction &action : redo) {
+        m_bytes += cost(action);
+        m_redo.push_back(action);
+    }
+    trim();
+    return true;
+}
@@ -0,0 +1,71 @@
+#ifndef TASKHISTORY_H
+#define TASKHISTORY_H
+
+#include <QVector>
+
+#include "task.h"
+#include "taskcontainers.h"
+
+class TaskStore;
+
+// Undo and redo for edits made through a TaskStore. Edits go through the
+// history, which applies them to the store and journals only the fields
+// that changed. The journal is a ring bounded by a byte budget: once it
+// is over, the oldest steps are dropped from the front.
+class TaskHistory {
+public:
+    static const qint64 kDefaultByteBudget = 4 * 1024 * 1024;
+
+    explicit TaskHistory(TaskStore *store, qint64 byteBudget = kDefaultByteBudget);
+
+    bool updateTask(const Task &task);
+    bool setStatus(int id, TaskStatus status);
+    bool removeTask(int id);
+    // One undo step and one store bulk edit for the lot. Return how many
+    // tasks changed.
+    int setStatuses(const QVector<int> &ids, TaskStatus status);
+    int removeTasks(const QVector<int> &ids);
+
+    // Everything recorded until the matching endGroup() is undone and
+    // redone as one step. Groups nest; only the outermost one counts.
+    void beginGroup();
+    void endGroup();
+
+    bool canUndo() const { return !m_undo.isEmpty(); }
+    bool canRedo() const { return !m_redo.isEmpty(); }
+    bool undo();
+    bool redo();
+    void clear();
+
+    qint64 byteBudget() const { return m_byteBudget; }
+    void setByteBudget(qint64 bytes);
+    // Estimated memory held by the journal, undo and redo together.
+    qint64 byteSize() const { return m_bytes; }
+    int undoSteps() const { return m_undoSteps; }
+
+    // Oldest first and bottom of the stack first, for persisting.
+    QVector<TaskAction> undoActions() const;
+    QVector<TaskAction> redoActions() const;
+    // Takes back what undoActions() and redoActions() returned. Ignored,
+    // returning false, once anything has been recorded.
+    bool restore(const QVector<TaskAction> &undo, const QVector<TaskAction> &redo);
+
+private:
+    TaskStore *m_store;
+    RingQueue<TaskAction> m_undo;
+    TaskActionStack m_redo;
+    qint64 m_byteBudget;
+    qint64 m_bytes;
+    int m_undoSteps;
+    int m_groupDepth;
+    bool m_groupStarted;
+
+    void record(TaskAction action);
+    void apply(TaskAction &action, bool undoing);
+    void applyStep(QVector<TaskAction> &step, bool undoing);
+    void clearRedo();
+    void trim();
+    static qint64 cost(const TaskAction &action);
+};
+
+#endif // TASKHISTORY_H
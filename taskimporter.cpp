@@ -0,0 +1,495 @@
+#include "taskimporter.h"
+#include "taskrepository.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QStringList>
+#include <QVariant>
+#include <cctype>
+
+namespace {
+
+class ByteReader {
+public:
+    explicit ByteReader(QIODevice &device) : m_device(device), m_pos(0) {}
+
+    int peek()
+    {
+        if (m_pos == m_buffer.size() && !refill())
+            return -1;
+        return uchar(m_buffer.at(m_pos));
+    }
+
+    int get()
+    {
+        int c = peek();
+        if (c != -1)
+            ++m_pos;
+        return c;
+    }
+
+    void skipBom()
+    {
+        if (peek() != 0xEF)
+            return;
+        if (m_buffer.size() - m_pos >= 3 && uchar(m_buffer.at(m_pos + 1)) == 0xBB && uchar(m_buffer.at(m_pos + 2)) == 0xBF)
+            m_pos += 3;
+    }
+
+private:
+    QIODevice &m_device;
+    QByteArray m_buffer;
+    int m_pos;
+
+    bool refill()
+    {
+        m_buffer = m_device.read(1 << 16);
+        m_pos = 0;
+        return !m_buffer.isEmpty();
+    }
+};
+
+// Pull parser for {"tasks": [ {...}, ... ]} or a bare [ {...}, ... ].
+// Only one task object is held in memory at a time.
+class JsonTaskReader {
+public:
+    explicit JsonTaskReader(ByteReader &in) : m_in(in), m_first(true) {}
+
+    QString error() const { return m_error; }
+
+    bool begin()
+    {
+        skipSpace();
+        if (m_in.peek() == '[') {
+            m_in.get();
+            return true;
+        }
+        if (!expect('{'))
+            return false;
+        bool firstKey = true;
+        while (true) {
+            skipSpace();
+            if (m_in.peek() == '}')
+                return setError("No \"tasks\" array found.");
+            if (!firstKey && !expect(','))
+                return false;
+            firstKey = false;
+            QString key;
+            if (!readString(key) || !expect(':'))
+                return false;
+            if (key == "tasks")
+                return expect('[');
+            if (!skipValue(0))
+                return false;
+        }
+    }
+
+    bool next(Task &task)
+    {
+        skipSpace();
+        if (m_in.peek() == ']') {
+            m_in.get();
+            return false;
+        }
+        if (!m_first && !expect(','))
+            return false;
+        m_first = false;
+        if (!expect('{'))
+            return false;
+
+        task = Task();
+        task.id = 0;
+        task.dueDay = kNoDueDay;
+        task.priority = 0;
+        task.status = TaskStatus::Pending;
+        bool firstField = true;
+        while (true) {
+            skipSpace();
+            if (m_in.peek() == '}') {
+                m_in.get();
+                return true;
+            }
+            if (!firstField && !expect(','))
+                return false;
+            firstField = false;
+            QString key;
+            QVariant value;
+            if (!readString(key) || !expect(':') || !readValue(value))
+                return false;
+            if (key == "title")
+                task.title = value.toString();
+            else if (key == "description")
+                task.description = value.toString();
+            else if (key == "dueDate" || key == "due_date")
+                parseDueDay(value.toString().trimmed(), &task.dueDay);
+            else if (key == "priority")
+                task.priority = value.toInt();
+            else if (key == "status")
+                parseTaskStatus(value.toString().trimmed(), &task.status);
+            else if (key == "subtasks" || key == "subTasks" || key == "sub_tasks")
+                task.subTasks = splitSubTasks(value.toString());
+        }
+    }
+
+private:
+    ByteReader &m_in;
+    bool m_first;
+    QString m_error;
+
+    bool setError(const QString &message)
+    {
+        if (m_error.isEmpty())
+            m_error = message;
+        return false;
+    }
+
+    void skipSpace()
+    {
+        int c = m_in.peek();
+        while (c == ' ' || c == '\n' || c == '\r' || c == '\t') {
+            m_in.get();
+            c = m_in.peek();
+        }
+    }
+
+    bool expect(char wanted)
+    {
+        skipSpace();
+        if (m_in.get() != wanted)
+            return setError(QString("Malformed JSON: expected '%1'.").arg(QChar(wanted)));
+        return true;
+    }
+
+    static int hexValue(int c)
+    {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    bool readString(QString &out)
+    {
+        if (!expect('"'))
+            return false;
+        out.clear();
+        QByteArray raw;
+        while (true) {
+            int c = m_in.get();
+            if (c == -1)
+                return setError("Malformed JSON: unterminated string.");
+            if (c == '"')
+                break;
+            if (c != '\\') {
+                raw.append(char(c));
+                continue;
+            }
+            if (!raw.isEmpty()) {
+                out += QString::fromUtf8(raw);
+                raw.clear();
+            }
+            int e = m_in.get();
+            switch (e) {
+            case '"': out += QChar('"'); break;
+            case '\\': out += QChar('\\'); break;
+            case '/': out += QChar('/'); break;
+            case 'b': out += QChar('\b'); break;
+            case 'f': out += QChar('\f'); break;
+            case 'n': out += QChar('\n'); break;
+            case 'r': out += QChar('\r'); break;
+            case 't': out += QChar('\t'); break;
+            case 'u': {
+                int code = 0;
+                for (int i = 0; i < 4; ++i) {
+                    int h = hexValue(m_in.get());
+                    if (h < 0)
+                        return setError("Malformed JSON: bad \\u escape.");
+                    code = code * 16 + h;
+                }
+                out += QChar(ushort(code));
+                break;
+            }
+            default:
+                return setError("Malformed JSON: bad escape sequence.");
+            }
+        }
+        if (!raw.isEmpty())
+            out += QString::fromUtf8(raw);
+        return true;
+    }
+
+    bool readScalar(QVariant &out)
+    {
+        QByteArray token;
+        int c = m_in.peek();
+        while (c != -1 && (std::isalnum(c) || c == '-' || c == '+' || c == '.')) {
+            token.append(char(m_in.get()));
+            c = m_in.peek();
+        }
+        if (token == "true")
+            out = true;
+        else if (token == "false")
+            out = false;
+        else if (token == "null")
+            out = QVariant();
+        else {
+            bool ok = false;
+            double number = token.toDouble(&ok);
+            if (!ok)
+                return setError("Malformed JSON: unexpected token.");
+            out = number;
+        }
+        return true;
+    }
+
+    bool readValue(QVariant &out)
+    {
+        skipSpace();
+        int c = m_in.peek();
+        if (c == '"') {
+            QString s;
+            if (!readString(s))
+                return false;
+            out = s;
+            return true;
+        }
+        if (c == '{' || c == '[') {
+            out = QVariant();
+            return skipValue(0);
+        }
+        return readScalar(out);
+    }
+
+    bool skipValue(int depth)
+    {
+        if (depth > 64)
+            return setError("Malformed JSON: nesting too deep.");
+        skipSpace();
+        int open = m_in.peek();
+        if (open == '"') {
+            QString ignored;
+            return readString(ignored);
+        }
+        if (open != '{' && open != '[') {
+            QVariant ignored;
+            return readScalar(ignored);
+        }
+        m_in.get();
+        char close = open == '{' ? '}' : ']';
+        bool first = true;
+        while (true) {
+            skipSpace();
+            if (m_in.peek() == close) {
+                m_in.get();
+                return true;
+            }
+            if (!first && !expect(','))
+                return false;
+            first = false;
+            if (open == '{') {
+                QString key;
+                if (!readString(key) || !expect(':'))
+                    return false;
+            }
+            if (!skipValue(depth + 1))
+                return false;
+        }
+    }
+};
+
+// RFC 4180 rows: quoted fields may hold commas, doubled quotes and newlines.
+class CsvReader {
+public:
+    explicit CsvReader(ByteReader &in) : m_in(in) {}
+
+    bool readRow(QStringList &fields)
+    {
+        do {
+            fields.clear();
+            if (m_in.peek() == -1)
+                return false;
+            bool endOfRow = false;
+            while (!endOfRow) {
+                QByteArray field;
+                if (m_in.peek() == '"') {
+                    m_in.get();
+                    while (true) {
+                        int c = m_in.get();
+                        if (c == -1)
+                            break;
+                        if (c == '"') {
+                            if (m_in.peek() != '"')
+                                break;
+                            m_in.get();
+                        }
+                        field.append(char(c));
+                    }
+                }
+                int c = m_in.peek();
+                while (c != -1 && c != ',' && c != '\n' && c != '\r') {
+                    field.append(char(m_in.get()));
+                    c = m_in.peek();
+                }
+                fields << QString::fromUtf8(field);
+
+                c = m_in.get();
+                if (c == '\r' && m_in.peek() == '\n')
+                    m_in.get();
+                endOfRow = c != ',';
+            }
+        } while (fields.size() == 1 && fields.first().isEmpty());
+        return true;
+    }
+
+private:
+    ByteReader &m_in;
+};
+
+}
+
+TaskImporter::TaskImporter(TaskRepository &repo)
+    : m_repo(repo), m_device(nullptr), m_imported(0), m_pending(0), m_inBatch(false), m_cancelled(false)
+{
+}
+
+bool TaskImporter::importFile(const QString &path, const Progress &progress)
+{
+    m_progress = progress;
+    m_imported = 0;
+    m_pending = 0;
+    m_inBatch = false;
+    m_cancelled = false;
+    m_error.clear();
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return fail("Could not open file for reading.");
+    m_device = &file;
+
+    bool ok = QFileInfo(path).suffix().compare("csv", Qt::CaseInsensitive) == 0
+        ? importCsv(file)
+        : importJson(file);
+    if (ok)
+        ok = commitBatch();
+    else if (m_inBatch)
+        m_repo.rollbackTransaction();
+
+    if (ok && m_progress)
+        m_progress(file.size(), file.size(), m_imported);
+    m_device = nullptr;
+    return ok;
+}
+
+bool TaskImporter::importJson(QIODevice &device)
+{
+    ByteReader in(device);
+    in.skipBom();
+    JsonTaskReader reader(in);
+    if (!reader.begin())
+        return fail(reader.error());
+
+    Task task;
+    while (reader.next(task)) {
+        if (!add(task))
+            return false;
+    }
+    if (!reader.error().isEmpty())
+        return fail(reader.error());
+    return true;
+}
+
+bool TaskImporter::importCsv(QIODevice &device)
+{
+    ByteReader in(device);
+    in.skipBom();
+    CsvReader reader(in);
+
+    QStringList fields;
+    if (!reader.readRow(fields))
+        return fail("The CSV file is empty.");
+
+    QHash<QString, int> column;
+    for (int i = 0; i < fields.size(); ++i)
+        column.insert(fields[i].trimmed().toLower(), i);
+    auto indexOf = [&column](std::initializer_list<const char *> names) {
+        for (const char *name : names) {
+            if (column.contains(name))
+                return column.value(name);
+        }
+        return -1;
+    };
+    const int titleCol = indexOf({"title"});
+    const int descCol = indexOf({"description"});
+    const int dueCol = indexOf({"duedate", "due_date"});
+    const int priorityCol = indexOf({"priority"});
+    const int statusCol = indexOf({"status"});
+    const int subTasksCol = indexOf({"subtasks", "sub_tasks"});
+    if (titleCol == -1)
+        return fail("The CSV header has no \"title\" column.");
+
+    auto field = [&fields](int col) {
+        return col >= 0 && col < fields.size() ? fields.at(col) : QString();
+    };
+    while (reader.readRow(fields)) {
+        Task task;
+        task.id = 0;
+        task.title = field(titleCol);
+        task.description = field(descCol);
+        task.dueDay = kNoDueDay;
+        parseDueDay(field(dueCol).trimmed(), &task.dueDay);
+        task.priority = field(priorityCol).toInt();
+        task.status = TaskStatus::Pending;
+        parseTaskStatus(field(statusCol).trimmed(), &task.status);
+        task.subTasks = splitSubTasks(field(subTasksCol));
+        if (!add(task))
+            return false;
+    }
+    return true;
+}
+
+bool TaskImporter::add(Task &task)
+{
+    if (task.title.trimmed().isEmpty())
+        return true;
+    task.priority = qBound(0, task.priority, 5);
+
+    if (!m_inBatch) {
+        if (!m_repo.beginTransaction())
+            return fail(m_repo.lastError());
+        m_inBatch = true;
+    }
+    if (m_repo.insertImportedTask(task) == -1)
+        return fail(m_repo.lastError());
+    if (++m_pending >= kBatchSize && !commitBatch())
+        return false;
+
+    // Checked well inside a batch, so a cancel takes effect promptly
+    // however slowly the batch commits.
+    const int read = m_imported + m_pending;
+    if (m_progress && read % kProgressInterval == 0
+        && !m_progress(m_device->pos(), m_device->size(), read)) {
+        m_cancelled = true;
+        m_error = "Import cancelled.";
+        return false;
+    }
+    return true;
+}
+
+bool TaskImporter::commitBatch()
+{
+    if (!m_inBatch)
+        return true;
+    if (!m_repo.commitTransaction())
+        return fail(m_repo.lastError());
+    m_inBatch = false;
+    m_imported += m_pending;
+    m_pending = 0;
+    return true;
+}
+
+bool TaskImporter::fail(const QString &message)
+{
+    if (m_error.isEmpty())
+        m_error = message;
+    return false;
+}
@@ -0,0 +1,51 @@
+#ifndef TASKIMPORTER_H
+#define TASKIMPORTER_H
+
+#include <QString>
+#include <functional>
+
+#include "task.h"
+
+class QIODevice;
+class TaskRepository;
+
+// Streams tasks from a JSON export (or a bare JSON array of task objects)
+// or a CSV file with a header row, and inserts them in large
+// transactions through one reused prepared statement. Imported tasks get
+// fresh ids.
+class TaskImporter {
+public:
+    // Called every kProgressInterval rows; return false to cancel. The open
+    // batch is rolled back, while batches already committed stay in the
+    // database. imported counts rows read so far, committed or not.
+    using Progress = std::function<bool(qint64 bytesRead, qint64 totalBytes, int imported)>;
+
+    explicit TaskImporter(TaskRepository &repo);
+
+    bool importFile(const QString &path, const Progress &progress = Progress());
+
+    int importedCount() const { return m_imported; }
+    bool wasCancelled() const { return m_cancelled; }
+    QString errorString() const { return m_error; }
+
+    static const int kBatchSize = 50000;
+    static const int kProgressInterval = 4096;
+
+private:
+    TaskRepository &m_repo;
+    Progress m_progress;
+    QIODevice *m_device;
+    int m_imported;
+    int m_pending;
+    bool m_inBatch;
+    bool m_cancelled;
+    QString m_error;
+
+    bool importJson(QIODevice &device);
+    bool importCsv(QIODevice &device);
+    bool add(Task &task);
+    bool commitBatch();
+    bool fail(const QString &message);
+};
+
+#endif // TASKIMPORTER_H
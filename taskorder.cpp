@@ -0,0 +1,132 @@
+#include "taskorder.h"
+#include "taskstore.h"
+
+#include <QThread>
+#include <algorithm>
+#include <vector>
+
+// Slices smaller than this are not worth a thread.
+static const int kMinSliceSize = 16384;
+
+TaskSortEntry taskSortEntry(TaskOrder order, int id, qint32 dueDay, int priority)
+{
+    // Flipping the sign bit makes unsigned comparison agree with signed.
+    const quint64 day = quint32(dueDay) ^ 0x80000000u;
+    const quint64 rank = quint8(127 - priority);
+    switch (order) {
+    case TaskOrder::ByDueDate:
+        return {day << 8 | rank, id};
+    case TaskOrder::ByPriority:
+        return {rank << 32 | day, id};
+    case TaskOrder::ById:
+        break;
+    }
+    return {0, id};
+}
+
+// Runs job(0) .. job(count - 1), all but the last on threads of their own.
+template <typename Job>
+static void runConcurrently(int count, Job job)
+{
+    std::vector<QThread *> threads;
+    threads.reserve(count);
+    for (int i = 0; i + 1 < count; ++i) {
+        threads.push_back(QThread::create(job, i));
+        threads.back()->start();
+    }
+    job(count - 1);
+    for (QThread *thread : threads) {
+        thread->wait();
+        delete thread;
+    }
+}
+
+void parallelStableSort(QVector<TaskSortEntry> &entries)
+{
+    const int n = entries.size();
+    const int slices = qMin(QThread::idealThreadCount(), n / kMinSliceSize);
+    if (slices < 2) {
+        std::stable_sort(entries.begin(), entries.end());
+        return;
+    }
+
+    QVector<int> bounds(slices + 1);
+    for (int i = 0; i <= slices; ++i)
+        bounds[i] = int(qint64(n) * i / slices);
+
+    TaskSortEntry *data = entries.data();
+    runConcurrently(slices, [data, &bounds](int s) {
+        std::stable_sort(data + bounds[s], data + bounds[s + 1]);
+    });
+
+    // std::merge takes from the left run on ties, so merging adjacent
+    // runs keeps the sort stable.
+    QVector<TaskSortEntry> buffer(n);
+    TaskSortEntry *from = data;
+    TaskSortEntry *to = buffer.data();
+    while (bounds.size() > 2) {
+        const int runs = bounds.size() - 1;
+        runConcurrently((runs + 1) / 2, [from, to, runs, &bounds](int p) {
+            const int lo = bounds[2 * p];
+            const int mid = bounds[qMin(2 * p + 1, runs)];
+            const int hi = bounds[qMin(2 * p + 2, runs)];
+            std::merge(from + lo, from + mid, from + mid, from + hi, to + lo);
+        });
+        QVector<int> merged;
+        for (int i = 0; i < bounds.size(); i += 2)
+            merged.push_back(bounds[i]);
+        if (merged.last() != n)
+            merged.push_back(n);
+        bounds = merged;
+        std::swap(from, to);
+    }
+    if (from != data)
+        std::copy(from, from + n, data);
+}
+
+TaskPermutation::TaskPermutation(TaskOrder order)
+    : m_order(order)
+{
+}
+
+void TaskPermutation::reset(const TaskColumns &columns, const QVector<int> &indices)
+{
+    m_entries.resize(indices.size());
+    for (int i = 0; i < indices.size(); ++i) {
+        const int idx = indices[i];
+        m_entries[i] = entry(columns.ids[idx], columns.dueDays[idx], columns.priorities[idx]);
+    }
+    parallelStableSort(m_entries);
+}
+
+int TaskPermutation::lowerBound(const TaskSortEntry &entry) const
+{
+    return int(std::lower_bound(m_entries.begin(), m_entries.end(), entry) - m_entries.begin());
+}
+
+int TaskPermutation::rowOf(const TaskSortEntry &entry) const
+{
+    const int row = lowerBound(entry);
+    if (row < m_entries.size() && m_entries[row].id == entry.id && m_entries[row].key == entry.key)
+        return row;
+    return -1;
+}
+
+void TaskPermutation::removeIds(const QSet<int> &ids)
+{
+    if (ids.isEmpty())
+        return;
+    auto kept = std::remove_if(m_entries.begin(), m_entries.end(),
+                               [&ids](const TaskSortEntry &entry) { return ids.contains(entry.id); });
+    m_entries.erase(kept, m_entries.end());
+}
+
+void TaskPermutation::merge(QVector<TaskSortEntry> entries)
+{
+    if (entries.isEmpty())
+        return;
+    parallelStableSort(entries);
+    QVector<TaskSortEntry> merged(m_entries.size() + entries.size());
+    std::merge(m_entries.cbegin(), m_entries.cend(), entries.cbegin(), entries.cend(), merged.begin());
+    m_entries.swap(merged);
+}
@@ -0,0 +1,68 @@
+#ifndef TASKORDER_H
+#define TASKORDER_H
+
+#include <QSet>
+#include <QVector>
+
+#include "task.h"
+
+struct TaskColumns;
+
+// A task's place in one order. Every order ends in the task id, so no
+// two tasks ever tie:
+//   ById        id
+//   ByDueDate   due day, then priority (highest first), then id
+//   ByPriority  priority (highest first), then due day, then id
+struct TaskSortEntry {
+    quint64 key;
+    int id;
+};
+
+inline bool operator<(const TaskSortEntry &a, const TaskSortEntry &b)
+{
+    return a.key != b.key ? a.key < b.key : a.id < b.id;
+}
+
+TaskSortEntry taskSortEntry(TaskOrder order, int id, qint32 dueDay, int priority);
+
+// Stable sort split across threads: slices are sorted concurrently and
+// then merged pairwise, a level at a time. Small inputs sort in place.
+void parallelStableSort(QVector<TaskSortEntry> &entries);
+
+// Ids of a set of tasks in one order, as a sorted array of entries that
+// edits patch in place instead of sorting again.
+class TaskPermutation {
+public:
+    explicit TaskPermutation(TaskOrder order = TaskOrder::ById);
+
+    TaskOrder order() const { return m_order; }
+    int size() const { return m_entries.size(); }
+    int idAt(int row) const { return m_entries.at(row).id; }
+
+    TaskSortEntry entry(int id, qint32 dueDay, int priority) const
+    {
+        return taskSortEntry(m_order, id, dueDay, priority);
+    }
+
+    // The tasks at the given indices of columns.
+    void reset(const TaskColumns &columns, const QVector<int> &indices);
+    void clear() { m_entries.clear(); }
+
+    // Row holding entry, or -1.
+    int rowOf(const TaskSortEntry &entry) const;
+    // Row entry would be inserted at.
+    int lowerBound(const TaskSortEntry &entry) const;
+    void insertAt(int row, const TaskSortEntry &entry) { m_entries.insert(row, entry); }
+    void removeAt(int row) { m_entries.remove(row); }
+
+    // Batch edits, each a single pass however many tasks they touch.
+    void removeIds(const QSet<int> &ids);
+    // entries need not be sorted.
+    void merge(QVector<TaskSortEntry> entries);
+
+private:
+    TaskOrder m_order;
+    QVector<TaskSortEntry> m_entries;
+};
+
+#endif // TASKORDER_H
@@ -0,0 +1,509 @@
+#include "taskrepository.h"
+#include "taskschema.h"
+#include <QDebug>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QVariant>
+
+const char *const TaskRepository::kTaskColumns = "id, title, description, due_date, sub_tasks, priority, status";
+
+TaskRepository::TaskRepository(const QString &connectionName)
+    : m_connectionName(connectionName), m_searchIndexReady(false)
+{
+}
+
+TaskRepository::~TaskRepository()
+{
+    close();
+    if (QSqlDatabase::contains(m_connectionName))
+        QSqlDatabase::removeDatabase(m_connectionName);
+}
+
+QSqlDatabase TaskRepository::database() const
+{
+    return QSqlDatabase::database(m_connectionName, false);
+}
+
+bool TaskRepository::open(const QString &path)
+{
+    close();
+    QSqlDatabase db = QSqlDatabase::contains(m_connectionName)
+        ? QSqlDatabase::database(m_connectionName, false)
+        : QSqlDatabase::addDatabase("QSQLITE", m_connectionName);
+    db.setDatabaseName(path);
+    db.setConnectOptions("QSQLITE_BUSY_TIMEOUT=5000");
+    if (!db.open()) {
+        m_lastError = db.lastError().text();
+        return false;
+    }
+    return configure() && createSchema();
+}
+
+void TaskRepository::close()
+{
+    for (std::unique_ptr<QSqlQuery> &query : m_statements)
+        query.reset();
+    if (QSqlDatabase::contains(m_connectionName)) {
+        QSqlDatabase db = database();
+        db.close();
+    }
+}
+
+bool TaskRepository::configure()
+{
+    // WAL lets the search and export readers run alongside writes; with
+    // synchronous=NORMAL a commit only fsyncs at checkpoints.
+    static const char *const pragmas[] = {
+        "PRAGMA journal_mode = WAL",
+        "PRAGMA synchronous = NORMAL",
+        "PRAGMA temp_store = MEMORY",
+        "PRAGMA cache_size = -65536",
+        "PRAGMA mmap_size = 268435456",
+    };
+    QSqlQuery query(database());
+    for (const char *pragma : pragmas) {
+        if (!query.exec(pragma)) {
+            m_lastError = query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool TaskRepository::createSchema()
+{
+    QSqlDatabase db = database();
+    if (!migrateSchema(db, &m_lastError))
+        return false;
+    m_searchIndexReady = ensureSearchIndex(db);
+    if (!m_searchIndexReady)
+        qWarning() << "FTS5 unavailable, search falls back to LIKE";
+    return true;
+}
+
+bool TaskRepository::exec(QSqlQuery &query)
+{
+    if (query.exec())
+        return true;
+    m_lastError = query.lastError().text();
+    return false;
+}
+
+QString TaskRepository::statementSql(Statement which)
+{
+    const QString select = QString("SELECT %1 FROM tasks").arg(kTaskColumns);
+    switch (which) {
+    case LoadById:
+        return select;
+    case LoadByDueDate:
+        return select + " ORDER BY due_date";
+    case LoadByPriority:
+        return select + " ORDER BY priority DESC";
+    case LoadOne:
+        return select + " WHERE id = ?";
+    case LoadOpenDueBy:
+        return select + " WHERE status IN ('pending', 'in progress') AND due_date <= ?";
+    case CountTasks:
+        return "SELECT COUNT(*) FROM tasks";
+    case ReadRevision:
+        return "SELECT value FROM task_meta WHERE key = 'revision'";
+    case InsertTask:
+        return "INSERT INTO tasks (title, description, due_date, sub_tasks, priority) VALUES (?, ?, ?, ?, ?)";
+    case RestoreTask:
+        return "INSERT INTO tasks (id, title, description, due_date, sub_tasks, priority, status) VALUES (?, ?, ?, ?, ?, ?, ?)";
+    case ImportTask:
+        return "INSERT INTO tasks (title, description, due_date, sub_tasks, priority, status) VALUES (?, ?, ?, ?, ?, ?)";
+    case UpdateTask:
+        return "UPDATE tasks SET title=?, description=?, due_date=?, sub_tasks=?, priority=?, status=? WHERE id=?";
+    case UpdateStatus:
+        return "UPDATE tasks SET status = ? WHERE id = ?";
+    case DeleteTask:
+        return "DELETE FROM tasks WHERE id = ?";
+    case LoadDependencies:
+        return "SELECT task_id, depends_on FROM task_dependencies";
+    case InsertDependency:
+        return "INSERT OR IGNORE INTO task_dependencies (task_id, depends_on) VALUES (?, ?)";
+    case DeleteDependency:
+        return "DELETE FROM task_dependencies WHERE task_id = ? AND depends_on = ?";
+    case LoadHistory:
+        return "SELECT redo, type, fields, joined, task_id, title, description, due_date, sub_tasks, priority, status, edges "
+               "FROM task_history ORDER BY seq";
+    case ClearHistory:
+        return "DELETE FROM task_history";
+    case InsertHistory:
+        return "INSERT INTO task_history (redo, type, fields, joined, task_id, title, description, due_date, sub_tasks, priority, status, edges) "
+               "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
+    case SearchFts:
+        return searchSql(true);
+    case SearchLike:
+        return searchSql(false);
+    case StatementCount:
+        break;
+    }
+    return QString();
+}
+
+QSqlQuery *TaskRepository::statement(Statement which)
+{
+    std::unique_ptr<QSqlQuery> &slot = m_statements[which];
+    if (!slot) {
+        std::unique_ptr<QSqlQuery> query(new QSqlQuery(database()));
+        query->setForwardOnly(true);
+        if (!query->prepare(statementSql(which))) {
+            m_lastError = query->lastError().text();
+            return nullptr;
+        }
+        slot = std::move(query);
+    }
+    return slot.get();
+}
+
+Task TaskRepository::taskFromQuery(const QSqlQuery &query)
+{
+    Task t;
+    t.id = query.value(0).toInt();
+    t.title = query.value(1).toString();
+    t.description = query.value(2).toString();
+    t.dueDay = dueDayFromColumn(query.value(3));
+    t.subTasks = splitSubTasks(query.value(4).toString());
+    t.priority = query.value(5).toInt();
+    if (!parseTaskStatus(query.value(6).toString(), &t.status))
+        t.status = TaskStatus::Pending;
+    return t;
+}
+
+bool TaskRepository::readTasks(QSqlQuery *query, QVector<Task> *tasks)
+{
+    if (!query || !exec(*query))
+        return false;
+    QVector<Task> read;
+    while (query->next())
+        read.push_back(taskFromQuery(*query));
+    if (query->lastError().isValid()) {
+        m_lastError = query->lastError().text();
+        query->finish();
+        return false;
+    }
+    query->finish();
+    tasks->swap(read);
+    return true;
+}
+
+TaskRepository::Statement TaskRepository::loadStatement(TaskOrder order)
+{
+    switch (order) {
+    case TaskOrder::ByDueDate:
+        return LoadByDueDate;
+    case TaskOrder::ByPriority:
+        return LoadByPriority;
+    case TaskOrder::ById:
+        break;
+    }
+    return LoadById;
+}
+
+bool TaskRepository::loadTasks(TaskOrder order, QVector<Task> *tasks)
+{
+    return readTasks(statement(loadStatement(order)), tasks);
+}
+
+bool TaskRepository::loadTask(int id, Task *task)
+{
+    QSqlQuery *query = statement(LoadOne);
+    if (!query)
+        return false;
+    query->bindValue(0, id);
+    if (!exec(*query))
+        return false;
+    bool found = query->next();
+    if (found && task)
+        *task = taskFromQuery(*query);
+    query->finish();
+    return found;
+}
+
+bool TaskRepository::loadOpenTasksDueBy(const QDate &date, QVector<Task> *tasks)
+{
+    QSqlQuery *query = statement(LoadOpenDueBy);
+    if (!query)
+        return false;
+    query->bindValue(0, date.toJulianDay());
+    return readTasks(query, tasks);
+}
+
+int TaskRepository::countTasks()
+{
+    QSqlQuery *query = statement(CountTasks);
+    if (!query || !exec(*query))
+        return -1;
+    int count = query->next() ? query->value(0).toInt() : 0;
+    query->finish();
+    return count;
+}
+
+qint64 TaskRepository::revision()
+{
+    QSqlQuery *query = statement(ReadRevision);
+    if (!query || !exec(*query))
+        return -1;
+    qint64 value = query->next() ? query->value(0).toLongLong() : -1;
+    query->finish();
+    return value;
+}
+
+bool TaskRepository::forEachTask(const std::function<bool(const Task &)> &visit, TaskOrder order)
+{
+    QSqlQuery *query = statement(loadStatement(order));
+    if (!query || !exec(*query))
+        return false;
+    bool stopped = false;
+    while (!stopped && query->next())
+        stopped = !visit(taskFromQuery(*query));
+    bool ok = stopped || !query->lastError().isValid();
+    if (!ok)
+        m_lastError = query->lastError().text();
+    query->finish();
+    return ok;
+}
+
+int TaskRepository::insertTask(const Task &task)
+{
+    QSqlQuery *query = statement(InsertTask);
+    if (!query)
+        return -1;
+    query->bindValue(0, task.title);
+    query->bindValue(1, task.description);
+    query->bindValue(2, dueDayToColumn(task.dueDay));
+    query->bindValue(3, joinSubTasks(task.subTasks));
+    query->bindValue(4, task.priority);
+    if (!exec(*query))
+        return -1;
+    return query->lastInsertId().toInt();
+}
+
+bool TaskRepository::restoreTask(const Task &task)
+{
+    QSqlQuery *q = statement(RestoreTask);
+    if (!q)
+        return false;
+    q->bindValue(0, task.id);
+    q->bindValue(1, task.title);
+    q->bindValue(2, task.description);
+    q->bindValue(3, dueDayToColumn(task.dueDay));
+    q->bindValue(4, joinSubTasks(task.subTasks));
+    q->bindValue(5, task.priority);
+    q->bindValue(6, taskStatusText(task.status));
+    return exec(*q);
+}
+
+bool TaskRepository::updateTask(const Task &task)
+{
+    QSqlQuery *q = statement(UpdateTask);
+    if (!q)
+        return false;
+    q->bindValue(0, task.title);
+    q->bindValue(1, task.description);
+    q->bindValue(2, dueDayToColumn(task.dueDay));
+    q->bindValue(3, joinSubTasks(task.subTasks));
+    q->bindValue(4, task.priority);
+    q->bindValue(5, taskStatusText(task.status));
+    q->bindValue(6, task.id);
+    return exec(*q);
+}
+
+bool TaskRepository::updateStatus(int id, TaskStatus status)
+{
+    QSqlQuery *updateQuery = statement(UpdateStatus);
+    if (!updateQuery)
+        return false;
+    updateQuery->bindValue(0, taskStatusText(status));
+    updateQuery->bindValue(1, id);
+    return exec(*updateQuery);
+}
+
+bool TaskRepository::removeTask(int id)
+{
+    QSqlQuery *deleteQuery = statement(DeleteTask);
+    if (!deleteQuery)
+        return false;
+    deleteQuery->bindValue(0, id);
+    return exec(*deleteQuery);
+}
+
+int TaskRepository::insertImportedTask(const Task &task)
+{
+    QSqlQuery *q = statement(ImportTask);
+    if (!q)
+        return -1;
+    q->bindValue(0, task.title);
+    q->bindValue(1, task.description);
+    q->bindValue(2, dueDayToColumn(task.dueDay));
+    q->bindValue(3, joinSubTasks(task.subTasks));
+    q->bindValue(4, task.priority);
+    q->bindValue(5, taskStatusText(task.status));
+    if (!exec(*q))
+        return -1;
+    return q->lastInsertId().toInt();
+}
+
+bool TaskRepository::loadDependencies(QVector<TaskDependency> *edges)
+{
+    QSqlQuery *query = statement(LoadDependencies);
+    if (!query || !exec(*query))
+        return false;
+    QVector<TaskDependency> read;
+    while (query->next())
+        read.push_back(TaskDependency{query->value(0).toInt(), query->value(1).toInt()});
+    if (query->lastError().isValid()) {
+        m_lastError = query->lastError().text();
+        query->finish();
+        return false;
+    }
+    query->finish();
+    edges->swap(read);
+    return true;
+}
+
+bool TaskRepository::addDependency(int taskId, int dependsOn)
+{
+    QSqlQuery *q = statement(InsertDependency);
+    if (!q)
+        return false;
+    q->bindValue(0, taskId);
+    q->bindValue(1, dependsOn);
+    return exec(*q);
+}
+
+bool TaskRepository::removeDependency(int taskId, int dependsOn)
+{
+    QSqlQuery *q = statement(DeleteDependency);
+    if (!q)
+        return false;
+    q->bindValue(0, taskId);
+    q->bindValue(1, dependsOn);
+    return exec(*q);
+}
+
+// History edges are stored as "taskId>dependsOn" pairs, comma-separated.
+static QString joinEdges(const QVector<TaskDependency> &edges)
+{
+    QStringList parts;
+    for (const TaskDependency &edge : edges)
+        parts.append(QString("%1>%2").arg(edge.taskId).arg(edge.dependsOn));
+    return parts.join(',');
+}
+
+static QVector<TaskDependency> splitEdges(const QString &text)
+{
+    QVector<TaskDependency> edges;
+    for (const QString &part : text.split(',', Qt::SkipEmptyParts)) {
+        const int sep = part.indexOf('>');
+        bool taskOk = false, dependsOk = false;
+        const TaskDependency edge = {part.left(sep).toInt(&taskOk), part.mid(sep + 1).toInt(&dependsOk)};
+        if (sep > 0 && taskOk && dependsOk)
+            edges.push_back(edge);
+    }
+    return edges;
+}
+
+bool TaskRepository::loadHistory(QVector<TaskAction> *undo, QVector<TaskAction> *redo)
+{
+    QSqlQuery *query = statement(LoadHistory);
+    if (!query || !exec(*query))
+        return false;
+    while (query->next()) {
+        TaskAction action = {};
+        action.type = query->value(1).toInt() == int(TaskActionType::Delete) ? TaskActionType::Delete : TaskActionType::Update;
+        action.fields = quint8(query->value(2).toUInt()) & TaskAction::AllFields;
+        action.joined = query->value(3).toBool();
+        action.task.id = query->value(4).toInt();
+        action.task.title = query->value(5).toString();
+        action.task.description = query->value(6).toString();
+        action.task.dueDay = dueDayFromColumn(query->value(7));
+        action.task.subTasks = splitSubTasks(query->value(8).toString());
+        action.task.priority = query->value(9).toInt();
+        if (!parseTaskStatus(query->value(10).toString(), &action.task.status))
+            action.task.status = TaskStatus::Pending;
+        action.edges = splitEdges(query->value(11).toString());
+        (query->value(0).toBool() ? redo : undo)->push_back(action);
+    }
+    query->finish();
+    return true;
+}
+
+bool TaskRepository::saveHistory(const QVector<TaskAction> &undo, const QVector<TaskAction> &redo)
+{
+    QSqlQuery *clear = statement(ClearHistory);
+    QSqlQuery *insert = statement(InsertHistory);
+    if (!clear || !insert)
+        return false;
+    return inTransaction([&]() {
+        if (!exec(*clear))
+            return false;
+        for (const QVector<TaskAction> *actions : {&undo, &redo}) {
+            for (const TaskAction &action : *actions) {
+                insert->bindValue(0, int(actions == &redo));
+                insert->bindValue(1, int(action.type));
+                insert->bindValue(2, int(action.fields));
+                insert->bindValue(3, int(action.joined));
+                insert->bindValue(4, action.task.id);
+                insert->bindValue(5, action.task.title);
+                insert->bindValue(6, action.task.description);
+                insert->bindValue(7, dueDayToColumn(action.task.dueDay));
+                insert->bindValue(8, joinSubTasks(action.task.subTasks));
+                insert->bindValue(9, action.task.priority);
+                insert->bindValue(10, taskStatusText(action.task.status));
+                insert->bindValue(11, joinEdges(action.edges));
+                if (!exec(*insert))
+                    return false;
+            }
+        }
+        return true;
+    });
+}
+
+bool TaskRepository::beginTransaction()
+{
+    QSqlDatabase db = database();
+    if (db.transaction())
+        return true;
+    m_lastError = db.lastError().text();
+    return false;
+}
+
+bool TaskRepository::commitTransaction()
+{
+    QSqlDatabase db = database();
+    if (db.commit())
+        return true;
+    m_lastError = db.lastError().text();
+    return false;
+}
+
+void TaskRepository::rollbackTransaction()
+{
+    QSqlDatabase db = database();
+    db.rollback();
+}
+
+bool TaskRepository::inTransaction(const std::function<bool()> &work)
+{
+    if (!beginTransaction())
+        return false;
+    if (work() && commitTransaction())
+        return true;
+    rollbackTransaction();
+    return false;
+}
+
+bool TaskRepository::search(const QString &text, int limit, const std::function<bool(const SearchHit &)> &visit)
+{
+    QSqlQuery *query = statement(m_searchIndexReady ? SearchFts : SearchLike);
+    if (!query)
+        return false;
+    if (runSearch(*query, text, m_searchIndexReady, limit, visit))
+        return true;
+    if (query->lastError().isValid())
+        m_lastError = query->lastError().text();
+    return false;
+}
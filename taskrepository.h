@@ -0,0 +1,112 @@
+#ifndef TASKREPOSITORY_H
+#define TASKREPOSITORY_H
+
+#include <QDate>
+#include <QSqlDatabase>
+#include <QString>
+#include <QVector>
+#include <functional>
+#include <memory>
+
+#include "task.h"
+#include "tasksearch.h"
+
+class QSqlQuery;
+
+// Synchronous SQL access to the tasks table over one long-lived named
+// connection. Must only be used from the thread that called open().
+class TaskRepository {
+public:
+    explicit TaskRepository(const QString &connectionName);
+    ~TaskRepository();
+
+    bool open(const QString &path);
+    void close();
+    QSqlDatabase database() const;
+    bool searchIndexReady() const { return m_searchIndexReady; }
+    QString lastError() const { return m_lastError; }
+
+    // Reads fail with false and lastError() set, leaving *tasks as it was,
+    // so a failed read is never mistaken for an empty table.
+    bool loadTasks(TaskOrder order, QVector<Task> *tasks);
+    // False if there is no task with that id.
+    bool loadTask(int id, Task *task);
+    bool loadOpenTasksDueBy(const QDate &date, QVector<Task> *tasks);
+    int countTasks();
+    // Bumped by triggers on every insert, update and delete; -1 on error.
+    qint64 revision();
+    // Streams every task off a forward-only cursor; stops early when
+    // visit returns false.
+    bool forEachTask(const std::function<bool(const Task &)> &visit, TaskOrder order = TaskOrder::ById);
+    int insertTask(const Task &task);
+    bool restoreTask(const Task &task);
+    bool updateTask(const Task &task);
+    bool updateStatus(int id, TaskStatus status);
+    bool removeTask(int id);
+    // Inserts with the task's own status and a fresh id; returns the id.
+    int insertImportedTask(const Task &task);
+
+    bool loadDependencies(QVector<TaskDependency> *edges);
+    // Does not check for cycles; TaskDag does that before edges get here.
+    bool addDependency(int taskId, int dependsOn);
+    bool removeDependency(int taskId, int dependsOn);
+
+    // The saved undo history, in the order TaskHistory::restore() takes it.
+    bool loadHistory(QVector<TaskAction> *undo, QVector<TaskAction> *redo);
+    // Replaces the saved history in one transaction.
+    bool saveHistory(const QVector<TaskAction> &undo, const QVector<TaskAction> &redo);
+
+    bool beginTransaction();
+    bool commitTransaction();
+    void rollbackTransaction();
+    // Runs work in its own transaction, committing only if it returns true.
+    bool inTransaction(const std::function<bool()> &work);
+    // False when visit stops the scan, or with lastError() set when the
+    // query fails.
+    bool search(const QString &text, int limit, const std::function<bool(const SearchHit &)> &visit);
+
+    // Reads a row selected with the columns of kTaskColumns, in order.
+    static Task taskFromQuery(const QSqlQuery &query);
+    static const char *const kTaskColumns;
+
+private:
+    enum Statement {
+        LoadById,
+        LoadByDueDate,
+        LoadByPriority,
+        LoadOne,
+        LoadOpenDueBy,
+        CountTasks,
+        ReadRevision,
+        InsertTask,
+        RestoreTask,
+        ImportTask,
+        UpdateTask,
+        UpdateStatus,
+        DeleteTask,
+        LoadDependencies,
+        InsertDependency,
+        DeleteDependency,
+        LoadHistory,
+        ClearHistory,
+        InsertHistory,
+        SearchFts,
+        SearchLike,
+        StatementCount
+    };
+
+    QString m_connectionName;
+    bool m_searchIndexReady;
+    QString m_lastError;
+    std::unique_ptr<QSqlQuery> m_statements[StatementCount];
+
+    bool configure();
+    bool createSchema();
+    bool exec(QSqlQuery &query);
+    QSqlQuery *statement(Statement which);
+    static Statement loadStatement(TaskOrder order);
+    static QString statementSql(Statement which);
+    bool readTasks(QSqlQuery *query, QVector<Task> *tasks);
+};
+
+#endif // TASKREPOSITORY_H
@@ -0,0 +1,242 @@
+#include "taskscheduler.h"
+#include "taskstore.h"
+#include <algorithm>
+
+TaskScheduler::TaskScheduler(QObject *parent)
+    : QObject(parent), m_store(nullptr), m_dirty(true)
+{
+}
+
+void TaskScheduler::setStore(TaskStore *store)
+{
+    if (m_store)
+        disconnect(m_store, nullptr, this, nullptr);
+    m_store = store;
+    markDirty();
+    if (!m_store)
+        return;
+    connect(m_store, &TaskStore::tasksReset, this, &TaskScheduler::markDirty);
+    connect(m_store, &TaskStore::dependenciesChanged, this, &TaskScheduler::markDirty);
+    connect(m_store, &TaskStore::taskAdded, this, &TaskScheduler::onTaskAdded);
+    connect(m_store, &TaskStore::taskUpdated, this, &TaskScheduler::onTaskUpdated);
+    connect(m_store, &TaskStore::taskRemoved, this, &TaskScheduler::onTaskRemoved);
+    connect(m_store, &TaskStore::tasksChanged, this, &TaskScheduler::onTasksChanged);
+}
+
+void TaskScheduler::markDirty()
+{
+    m_dirty = true;
+}
+
+TaskScheduler::Entry TaskScheduler::entryAt(int idx) const
+{
+    const TaskColumns &columns = m_store->columns();
+    const int id = columns.ids[idx];
+    Entry entry;
+    entry.chain = m_store->dependencies().chainLength(id);
+    entry.priority = columns.priorities[idx];
+    entry.dueDay = columns.dueDays[idx];
+    entry.complete = columns.statuses[idx] == TaskStatus::Complete;
+    entry.unmet = 0;
+    for (int dep : m_store->dependencies().dependenciesOf(id)) {
+        const int depIdx = m_store->indexOf(dep);
+        if (depIdx != -1 && columns.statuses[depIdx] != TaskStatus::Complete)
+            ++entry.unmet;
+    }
+    return entry;
+}
+
+void TaskScheduler::rebuild()
+{
+    m_entries.clear();
+    m_heap.clear();
+    m_heapPos.clear();
+    m_dirty = false;
+    if (!m_store)
+        return;
+
+    // Reads only the store's hot columns.
+    const QVector<int> &ids = m_store->columns().ids;
+    m_entries.reserve(ids.size());
+    for (int idx = 0; idx < ids.size(); ++idx) {
+        const Entry entry = entryAt(idx);
+        m_entries.insert(ids[idx], entry);
+        if (!entry.complete && entry.unmet == 0)
+            m_heap.push_back(ids[idx]);
+    }
+    m_heapPos.reserve(m_heap.size());
+    for (int pos = 0; pos < m_heap.size(); ++pos)
+        m_heapPos.insert(m_heap[pos], pos);
+    for (int pos = m_heap.size() / 2 - 1; pos >= 0; --pos)
+        siftDown(pos);
+}
+
+bool TaskScheduler::ranksBefore(int a, int b) const
+{
+    // Every task in the heap is ready, so none waits on another; the
+    // chain only breaks ties, favouring work that unblocks the most.
+    const Entry &ea = *m_entries.constFind(a);
+    const Entry &eb = *m_entries.constFind(b);
+    if (ea.priority != eb.priority)
+        return ea.priority > eb.priority;
+    if (ea.dueDay != eb.dueDay)
+        return ea.dueDay < eb.dueDay;
+    if (ea.chain != eb.chain)
+        return ea.chain > eb.chain;
+    return a < b;
+}
+
+void TaskScheduler::place(int pos, int id)
+{
+    m_heap[pos] = id;
+    m_heapPos[id] = pos;
+}
+
+void TaskScheduler::siftUp(int pos)
+{
+    const int id = m_heap[pos];
+    while (pos > 0) {
+        const int parent = (pos - 1) / 2;
+        if (!ranksBefore(id, m_heap[parent]))
+            break;
+        place(pos, m_heap[parent]);
+        pos = parent;
+    }
+    place(pos, id);
+}
+
+void TaskScheduler::siftDown(int pos)
+{
+    const int id = m_heap[pos];
+    const int count = m_heap.size();
+    for (;;) {
+        int best = 2 * pos + 1;
+        if (best >= count)
+            break;
+        if (best + 1 < count && ranksBefore(m_heap[best + 1], m_heap[best]))
+            ++best;
+        if (!ranksBefore(m_heap[best], id))
+            break;
+        place(pos, m_heap[best]);
+        pos = best;
+    }
+    place(pos, id);
+}
+
+void TaskScheduler::setReady(int id, bool ready)
+{
+    const int pos = m_heapPos.value(id, -1);
+    if (ready == (pos != -1))
+        return;
+    if (ready) {
+        m_heap.push_back(id);
+        m_heapPos.insert(id, m_heap.size() - 1);
+        siftUp(m_heap.size() - 1);
+        return;
+    }
+    m_heapPos.remove(id);
+    const int last = m_heap.takeLast();
+    if (pos == m_heap.size())
+        return;
+    place(pos, last);
+    siftDown(pos);
+    siftUp(m_heapPos.value(last));
+}
+
+void TaskScheduler::onTaskAdded(const Task &task)
+{
+    if (m_dirty)
+        return;
+    const int idx = m_store->indexOf(task.id);
+    if (idx == -1)
+        return;
+    const Entry entry = entryAt(idx);
+    m_entries.insert(task.id, entry);
+    setReady(task.id, !entry.complete && entry.unmet == 0);
+}
+
+void TaskScheduler::onTaskUpdated(const Task &task)
+{
+    if (m_dirty)
+        return;
+    auto it = m_entries.find(task.id);
+    if (it == m_entries.end()) {
+        onTaskAdded(task);
+        return;
+    }
+
+    const bool complete = task.status == TaskStatus::Complete;
+    if (complete != it->complete) {
+        it->complete = complete;
+        const int delta = complete ? -1 : 1;
+        for (int dependent : m_store->dependencies().dependentsOf(task.id)) {
+            auto entry = m_entries.find(dependent);
+            if (entry == m_entries.end())
+                continue;
+            entry->unmet += delta;
+            setReady(dependent, !entry->complete && entry->unmet == 0);
+        }
+    }
+
+    const bool rekeyed = it->priority != task.priority || it->dueDay != task.dueDay;
+    it->priority = task.priority;
+    it->dueDay = task.dueDay;
+    const bool ready = !it->complete && it->unmet == 0;
+
+    const int pos = m_heapPos.value(task.id, -1);
+    if (rekeyed && pos != -1 && ready) {
+        siftUp(pos);
+        siftDown(m_heapPos.value(task.id));
+    }
+    setReady(task.id, ready);
+}
+
+void TaskScheduler::onTaskRemoved(int id)
+{
+    // A task that had edges also changes its dependencies, which rebuilds.
+    if (m_dirty)
+        return;
+    setReady(id, false);
+    m_entries.remove(id);
+}
+
+void TaskScheduler::onTasksChanged(const QVector<Task> &changed, const QVector<int> &removed)
+{
+    for (int id : removed)
+        onTaskRemoved(id);
+    for (const Task &task : changed)
+        onTaskUpdated(task);
+}
+
+int TaskScheduler::readyCount()
+{
+    if (m_dirty)
+        rebuild();
+    return m_heap.size();
+}
+
+QVector<Task> TaskScheduler::recommend(int maxRecs)
+{
+    if (m_dirty)
+        rebuild();
+
+    // Best-first walk of the heap: the next best entry is always a child of
+    // one already taken, so only a frontier of at most maxRecs + 1 heap
+    // slots is ever compared.
+    QVector<Task> recs;
+    QVector<int> frontier;
+    auto worse = [this](int a, int b) { return ranksBefore(m_heap[b], m_heap[a]); };
+    if (!m_heap.isEmpty())
+        frontier.push_back(0);
+    while (!frontier.isEmpty() && recs.size() < maxRecs) {
+        std::pop_heap(frontier.begin(), frontier.end(), worse);
+        const int pos = frontier.takeLast();
+        if (const Task *task = m_store->taskById(m_heap[pos]))
+            recs.push_back(*task);
+        for (int child = 2 * pos + 1; child <= 2 * pos + 2 && child < m_heap.size(); ++child) {
+            frontier.push_back(child);
+            std::push_heap(frontier.begin(), frontier.end(), worse);
+        }
+    }
+    return recs;
+}
@@ -0,0 +1,63 @@
+#ifndef TASKSCHEDULER_H
+#define TASKSCHEDULER_H
+
+#include <QHash>
+#include <QObject>
+#include <QVector>
+
+#include "task.h"
+
+class TaskStore;
+
+// Recommends the store's ready tasks: open, with every dependency
+// complete. Each task keeps a count of its unmet dependencies, and the
+// ready ones sit in a binary heap ranked by priority, then due date, then
+// critical path (the longest chain of tasks waiting on it), then id.
+//
+// A status change adjusts only the counters of the task's dependents and
+// moves them in or out of the heap; a new priority or due date re-sifts
+// one entry. Only a reload or a dependency edit rebuilds everything.
+class TaskScheduler : public QObject {
+    Q_OBJECT
+
+public:
+    explicit TaskScheduler(QObject *parent = nullptr);
+
+    void setStore(TaskStore *store);
+
+    // The best maxRecs ready tasks, best first, in O(maxRecs log maxRecs).
+    QVector<Task> recommend(int maxRecs = 5);
+    int readyCount();
+
+private slots:
+    void markDirty();
+    void onTaskAdded(const Task &task);
+    void onTaskUpdated(const Task &task);
+    void onTaskRemoved(int id);
+    void onTasksChanged(const QVector<Task> &changed, const QVector<int> &removed);
+
+private:
+    struct Entry {
+        int chain;
+        int priority;
+        qint32 dueDay;
+        bool complete;
+        int unmet;
+    };
+
+    TaskStore *m_store;
+    QHash<int, Entry> m_entries;
+    QVector<int> m_heap;
+    QHash<int, int> m_heapPos;
+    bool m_dirty;
+
+    void rebuild();
+    Entry entryAt(int idx) const;
+    bool ranksBefore(int a, int b) const;
+    void setReady(int id, bool ready);
+    void place(int pos, int id);
+    void siftUp(int pos);
+    void siftDown(int pos);
+};
+
+#endif // TASKSCHEDULER_H
@@ -0,0 +1,163 @@
+#include "taskschema.h"
+#include "task.h"
+#include <QDate>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStringList>
+#include <QVector>
+
+struct Migration {
+    int version;
+    QStringList statements;
+};
+
+static QVector<Migration> migrations()
+{
+    return {
+        // 1: the original table, kept so old and new files share a starting point.
+        { 1, {
+            "CREATE TABLE IF NOT EXISTS tasks ("
+            "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+            "title TEXT NOT NULL,"
+            "description TEXT,"
+            "due_date TEXT,"
+            "sub_tasks TEXT,"
+            "priority INTEGER DEFAULT 0,"
+            "completed INTEGER DEFAULT 0,"
+            "status TEXT DEFAULT 'pending',"
+            "UNIQUE(id)"
+            ")"
+        } },
+        // 2: integer day due dates, drop the unused completed column and the
+        // redundant UNIQUE(id), and index the sort and notification paths.
+        { 2, {
+            "CREATE TABLE tasks_v2 ("
+            "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+            "title TEXT NOT NULL,"
+            "description TEXT,"
+            "due_date INTEGER,"
+            "sub_tasks TEXT,"
+            "priority INTEGER NOT NULL DEFAULT 0,"
+            "status TEXT NOT NULL DEFAULT 'pending'"
+            ")",
+            "INSERT INTO tasks_v2 (id, title, description, due_date, sub_tasks, priority, status) "
+            "SELECT id, title, description, "
+            "CASE WHEN date(due_date) IS NOT NULL THEN CAST(julianday(date(due_date)) + 0.5 AS INTEGER) END, "
+            "sub_tasks, COALESCE(priority, 0), COALESCE(status, 'pending') FROM tasks",
+            "DROP TABLE tasks",
+            "ALTER TABLE tasks_v2 RENAME TO tasks",
+            "CREATE INDEX idx_tasks_due_date ON tasks(due_date, id)",
+            "CREATE INDEX idx_tasks_priority ON tasks(priority DESC, id)",
+            "CREATE INDEX idx_tasks_status_due_date ON tasks(status, due_date)"
+        } },
+        // 3: a revision counter bumped by every write to tasks, so a cached
+        // snapshot of the table can be checked without reading it.
+        { 3, {
+            "CREATE TABLE task_meta (key TEXT PRIMARY KEY, value INTEGER NOT NULL) WITHOUT ROWID",
+            "INSERT INTO task_meta (key, value) VALUES ('revision', 1)",
+            "CREATE TRIGGER tasks_revision_ai AFTER INSERT ON tasks BEGIN "
+            "UPDATE task_meta SET value = value + 1 WHERE key = 'revision'; END",
+            "CREATE TRIGGER tasks_revision_au AFTER UPDATE ON tasks BEGIN "
+            "UPDATE task_meta SET value = value + 1 WHERE key = 'revision'; END",
+            "CREATE TRIGGER tasks_revision_ad AFTER DELETE ON tasks BEGIN "
+            "UPDATE task_meta SET value = value + 1 WHERE key = 'revision'; END"
+        } },
+        // 4: explicit dependencies between tasks, indexed both ways, and
+        // dropped together with either of their tasks.
+        { 4, {
+            "CREATE TABLE task_dependencies ("
+            "task_id INTEGER NOT NULL,"
+            "depends_on INTEGER NOT NULL,"
+            "PRIMARY KEY (task_id, depends_on),"
+            "CHECK (task_id != depends_on)"
+            ") WITHOUT ROWID",
+            "CREATE INDEX idx_task_dependencies_depends_on ON task_dependencies(depends_on, task_id)",
+            "CREATE TRIGGER tasks_dependencies_ad AFTER DELETE ON tasks BEGIN "
+            "DELETE FROM task_dependencies WHERE task_id = old.id OR depends_on = old.id; END"
+        } },
+        // 5: the undo history, saved on exit so it survives a restart. Rows
+        // hold only the fields in their mask; seq keeps them in order.
+        { 5, {
+            "CREATE TABLE task_history ("
+            "seq INTEGER PRIMARY KEY,"
+            "redo INTEGER NOT NULL,"
+            "type INTEGER NOT NULL,"
+            "fields INTEGER NOT NULL,"
+            "joined INTEGER NOT NULL,"
+            "task_id INTEGER NOT NULL,"
+            "title TEXT,"
+            "description TEXT,"
+            "due_date INTEGER,"
+            "sub_tasks TEXT,"
+            "priority INTEGER,"
+            "status TEXT"
+            ")"
+        } },
+        // 6: a deleted task's dependency edges, restored with it on undo.
+        { 6, {
+            "ALTER TABLE task_history ADD COLUMN edges TEXT"
+        } },
+    };
+}
+
+int latestSchemaVersion()
+{
+    return migrations().last().version;
+}
+
+static int schemaVersion(QSqlDatabase &db)
+{
+    QSqlQuery query("PRAGMA user_version", db);
+    return query.next() ? query.value(0).toInt() : 0;
+}
+
+bool migrateSchema(QSqlDatabase &db, QString *error)
+{
+    int current = schemaVersion(db);
+    for (const Migration &step : migrations()) {
+        if (step.version <= current)
+            continue;
+
+        if (!db.transaction()) {
+            if (error)
+                *error = QString("Schema migration %1 failed: %2").arg(step.version).arg(db.lastError().text());
+            return false;
+        }
+        // The version is written in the same transaction, so a step is
+        // either applied and recorded or not applied at all.
+        QSqlQuery query(db);
+        QStringList statements = step.statements;
+        statements.append(QString("PRAGMA user_version = %1").arg(step.version));
+        for (const QString &sql : statements) {
+            if (!query.exec(sql)) {
+                if (error)
+                    *error = QString("Schema migration %1 failed: %2").arg(step.version).arg(query.lastError().text());
+                db.rollback();
+                return false;
+            }
+        }
+        if (!db.commit()) {
+            if (error)
+                *error = db.lastError().text();
+            db.rollback();
+            return false;
+        }
+        current = step.version;
+    }
+    return true;
+}
+
+QVariant dueDayToColumn(qint32 dueDay)
+{
+    if (dueDay == kNoDueDay)
+        return QVariant();
+    return dueDay;
+}
+
+qint32 dueDayFromColumn(const QVariant &value)
+{
+    if (value.isNull())
+        return kNoDueDay;
+    return qint32(value.toLongLong());
+}
@@ -0,0 +1,19 @@
+#ifndef TASKSCHEMA_H
+#define TASKSCHEMA_H
+
+#include <QString>
+#include <QVariant>
+
+class QSqlDatabase;
+
+// Brings the database up to the latest schema version, one step per
+// PRAGMA user_version increment, each in its own transaction.
+bool migrateSchema(QSqlDatabase &db, QString *error);
+int latestSchemaVersion();
+
+// due_date is stored as a Julian day number so it sorts and range-scans
+// as an integer, NULL when the task has none.
+QVariant dueDayToColumn(qint32 dueDay);
+qint32 dueDayFromColumn(const QVariant &value);
+
+#endif // TASKSCHEMA_H
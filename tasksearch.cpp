@@ -0,0 +1,132 @@
+#include "tasksearch.h"
+#include "taskschema.h"
+#include "task.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QStringList>
+#include <QVariant>
+
+static const QChar kMatchOpen(0x1);
+static const QChar kMatchClose(0x2);
+
+bool ensureSearchIndex(QSqlDatabase &db)
+{
+    QSqlQuery query(db);
+    if (!query.exec("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'tasks_fts'"))
+        return false;
+    bool exists = query.next();
+    query.finish();
+
+    QStringList statements;
+    if (!exists) {
+        statements << "CREATE VIRTUAL TABLE tasks_fts USING fts5("
+                      "title, description, sub_tasks,"
+                      "content='tasks', content_rowid='id',"
+                      "tokenize='unicode61 remove_diacritics 2',"
+                      "prefix='2 3'"
+                      ")";
+    }
+    statements << "CREATE TRIGGER IF NOT EXISTS tasks_fts_ai AFTER INSERT ON tasks BEGIN "
+                  "INSERT INTO tasks_fts(rowid, title, description, sub_tasks) "
+                  "VALUES (new.id, new.title, new.description, new.sub_tasks); "
+                  "END";
+    statements << "CREATE TRIGGER IF NOT EXISTS tasks_fts_ad AFTER DELETE ON tasks BEGIN "
+                  "INSERT INTO tasks_fts(tasks_fts, rowid, title, description, sub_tasks) "
+                  "VALUES ('delete', old.id, old.title, old.description, old.sub_tasks); "
+                  "END";
+    // Status flips do not touch the indexed columns, so they skip the index.
+    statements << "CREATE TRIGGER IF NOT EXISTS tasks_fts_au AFTER UPDATE OF title, description, sub_tasks ON tasks BEGIN "
+                  "INSERT INTO tasks_fts(tasks_fts, rowid, title, description, sub_tasks) "
+                  "VALUES ('delete', old.id, old.title, old.description, old.sub_tasks); "
+                  "INSERT INTO tasks_fts(rowid, title, description, sub_tasks) "
+                  "VALUES (new.id, new.title, new.description, new.sub_tasks); "
+                  "END";
+    if (!exists)
+        statements << "INSERT INTO tasks_fts(tasks_fts) VALUES ('rebuild')";
+
+    // All or nothing: an index without its triggers, or never filled,
+    // would silently drift from the tasks table. On failure search falls
+    // back to LIKE.
+    if (!db.transaction())
+        return false;
+    for (const QString &sql : statements) {
+        if (!query.exec(sql)) {
+            db.rollback();
+            return false;
+        }
+    }
+    if (!db.commit()) {
+        db.rollback();
+        return false;
+    }
+    return true;
+}
+
+QString ftsMatchExpression(const QString &text)
+{
+    QStringList terms;
+    const QStringList words = text.split(' ', Qt::SkipEmptyParts);
+    for (QString word : words) {
+        word.replace('"', "\"\"");
+        terms << "\"" + word + "\"*";
+    }
+    return terms.join(' ');
+}
+
+const char *searchSql(bool useFts)
+{
+    if (useFts)
+        return "SELECT t.id, t.title, t.due_date, "
+               "snippet(tasks_fts, -1, char(1), char(2), '...', 12) "
+               "FROM tasks_fts JOIN tasks t ON t.id = tasks_fts.rowid "
+               "WHERE tasks_fts MATCH ? ORDER BY rank LIMIT ?";
+    return "SELECT id, title, due_date, description FROM tasks "
+           "WHERE title LIKE ? OR description LIKE ? LIMIT ?";
+}
+
+bool runSearch(QSqlQuery &query, const QString &text, bool useFts, int limit,
+               const std::function<bool(const SearchHit &)> &visit)
+{
+    if (useFts) {
+        QString match = ftsMatchExpression(text);
+        if (match.isEmpty())
+            return true;
+        query.bindValue(0, match);
+        query.bindValue(1, limit);
+    } else {
+        QString pattern = "%" + text + "%";
+        query.bindValue(0, pattern);
+        query.bindValue(1, pattern);
+        query.bindValue(2, limit);
+    }
+    if (!query.exec())
+        return false;
+    while (query.next()) {
+        SearchHit hit;
+        hit.id = query.value(0).toInt();
+        hit.title = query.value(1).toString();
+        hit.dueDay = dueDayFromColumn(query.value(2));
+        QString snippet = query.value(3).toString();
+        if (!useFts)
+            snippet.truncate(160);
+        hit.snippet = snippet.toHtmlEscaped();
+        hit.snippet.replace(kMatchOpen, "<b>").replace(kMatchClose, "</b>");
+        if (!visit(hit)) {
+            query.finish();
+            return false;
+        }
+    }
+    query.finish();
+    return true;
+}
+
+QString searchHitHtml(const SearchHit &hit)
+{
+    QString html = QString("(%1) %2 - Due: %3")
+                       .arg(hit.id)
+                       .arg(hit.title.toHtmlEscaped())
+                       .arg(dueDayText(hit.dueDay));
+    if (!hit.snippet.isEmpty())
+        html += "<br><small>" + hit.snippet + "</small>";
+    return html;
+}
@@ -0,0 +1,39 @@
+#ifndef TASKSEARCH_H
+#define TASKSEARCH_H
+
+#include <QMetaType>
+#include <QString>
+#include <QVector>
+#include <functional>
+
+class QSqlDatabase;
+class QSqlQuery;
+
+struct SearchHit {
+    int id;
+    QString title;
+    qint32 dueDay;
+    QString snippet;   // HTML, matched terms wrapped in <b>
+};
+
+Q_DECLARE_METATYPE(SearchHit)
+
+// Creates the tasks_fts index and its sync triggers when missing, in one
+// transaction. Returns false, leaving nothing half set up, when the SQLite
+// build has no FTS5 or any step fails.
+bool ensureSearchIndex(QSqlDatabase &db);
+
+QString ftsMatchExpression(const QString &text);
+
+// SQL for a search statement; bind the term and the row limit.
+const char *searchSql(bool useFts);
+
+// Runs a statement prepared from searchSql() and streams hits to visit in
+// rank order; visit returns false to stop early. Returns false when the
+// scan was stopped before the last row or the statement failed.
+bool runSearch(QSqlQuery &query, const QString &text, bool useFts, int limit,
+               const std::function<bool(const SearchHit &)> &visit);
+
+QString searchHitHtml(const SearchHit &hit);
+
+#endif // TASKSEARCH_H
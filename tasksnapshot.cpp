@@ -0,0 +1,222 @@
+#include "tasksnapshot.h"
+#include <QFile>
+#include <QSaveFile>
+#include <cstring>
+
+namespace {
+
+const quint32 kMagic = 0x4E534454; // "TDSN" read little-endian
+
+struct SnapshotHeader {
+    quint32 magic;
+    quint32 version;
+    qint64 revision;
+    quint32 taskCount;
+    quint32 poolSize;
+    quint32 checksum;
+    quint32 reserved;
+};
+
+// String fields are offsets into the pool; subTasks is the joined list.
+struct SnapshotRecord {
+    qint32 id;
+    qint32 dueDay;
+    quint32 title;
+    quint32 description;
+    quint32 subTasks;
+    quint8 priority;
+    quint8 status;
+    quint16 reserved;
+};
+
+static_assert(sizeof(SnapshotHeader) == 32, "snapshot header layout changed");
+static_assert(sizeof(SnapshotRecord) == 24, "snapshot record layout changed");
+
+// Short strings (sub-task lists, repeated titles) are shared in the pool;
+// longer ones are rarely duplicated and would only bloat the intern table.
+const int kMaxInternedLength = 32;
+
+quint32 fnv1a(const uchar *data, qint64 size, quint32 hash = 2166136261u)
+{
+    for (qint64 i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+bool readString(const uchar *pool, quint32 poolSize, quint32 offset, QString &out)
+{
+    quint32 length;
+    if (offset > poolSize || poolSize - offset < sizeof(length))
+        return false;
+    std::memcpy(&length, pool + offset, sizeof(length));
+    offset += sizeof(length);
+    if (poolSize - offset < length)
+        return false;
+    out = QString::fromUtf8(reinterpret_cast<const char *>(pool + offset), int(length));
+    return true;
+}
+
+}
+
+TaskSnapshot::TaskSnapshot()
+    : m_revision(-1)
+{
+}
+
+bool TaskSnapshot::load(const QString &path)
+{
+    m_tasks.clear();
+    m_revision = -1;
+    m_error.clear();
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return fail("No snapshot.");
+    const qint64 size = file.size();
+    if (size < qint64(sizeof(SnapshotHeader)))
+        return fail("Snapshot is truncated.");
+    uchar *data = file.map(0, size);
+    if (!data)
+        return fail(file.errorString());
+
+    SnapshotHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    const qint64 expected = qint64(sizeof(header)) + qint64(header.taskCount) * qint64(sizeof(SnapshotRecord)) + header.poolSize;
+    bool ok = header.magic == kMagic && header.version == kVersion;
+    if (!ok)
+        fail("Snapshot has an unknown format.");
+    else if (!(ok = expected == size))
+        fail("Snapshot is truncated.");
+    else if (!(ok = fnv1a(data + sizeof(header), size - qint64(sizeof(header))) == header.checksum))
+        fail("Snapshot checksum mismatch.");
+
+    if (ok) {
+        const uchar *records = data + sizeof(header);
+        const uchar *pool = records + qint64(header.taskCount) * qint64(sizeof(SnapshotRecord));
+        // Sub-task lists repeat across many tasks; split each interned one
+        // once and let the lists share their data.
+        QHash<quint32, QStringList> shared;
+        auto sharedSubTasks = [&](quint32 offset, QStringList &out) {
+            auto it = shared.constFind(offset);
+            if (it != shared.constEnd()) {
+                out = it.value();
+                return true;
+            }
+            QString text;
+            if (!readString(pool, header.poolSize, offset, text))
+                return false;
+            out = splitSubTasks(text);
+            if (text.size() <= kMaxInternedLength)
+                shared.insert(offset, out);
+            return true;
+        };
+
+        m_tasks.resize(int(header.taskCount));
+        for (quint32 i = 0; ok && i < header.taskCount; ++i) {
+            SnapshotRecord record;
+            std::memcpy(&record, records + qint64(i) * qint64(sizeof(record)), sizeof(record));
+            Task &task = m_tasks[int(i)];
+            task.id = record.id;
+            task.dueDay = record.dueDay;
+            task.priority = record.priority;
+            task.status = TaskStatus(record.status);
+            ok = record.status <= quint8(TaskStatus::Complete)
+                && readString(pool, header.poolSize, record.title, task.title)
+                && readString(pool, header.poolSize, record.description, task.description)
+                && sharedSubTasks(record.subTasks, task.subTasks);
+        }
+        if (!ok) {
+            m_tasks.clear();
+            fail("Snapshot records are corrupt.");
+        }
+    }
+
+    file.unmap(data);
+    if (ok)
+        m_revision = header.revision;
+    return ok;
+}
+
+qint64 TaskSnapshot::readRevision(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return -1;
+    SnapshotHeader header;
+    if (file.read(reinterpret_cast<char *>(&header), sizeof(header)) != qint64(sizeof(header)))
+        return -1;
+    if (header.magic != kMagic || header.version != kVersion)
+        return -1;
+    return header.revision;
+}
+
+bool TaskSnapshot::fail(const QString &message)
+{
+    if (m_error.isEmpty())
+        m_error = message;
+    return false;
+}
+
+TaskSnapshotWriter::TaskSnapshotWriter()
+    : m_count(0)
+{
+}
+
+quint32 TaskSnapshotWriter::addString(const QString &text)
+{
+    const bool intern = text.size() <= kMaxInternedLength;
+    if (intern) {
+        auto it = m_interned.constFind(text);
+        if (it != m_interned.constEnd())
+            return it.value();
+    }
+
+    const quint32 offset = quint32(m_pool.size());
+    const QByteArray utf8 = text.toUtf8();
+    const quint32 length = quint32(utf8.size());
+    m_pool.append(reinterpret_cast<const char *>(&length), sizeof(length));
+    m_pool.append(utf8);
+    if (intern)
+        m_interned.insert(text, offset);
+    return offset;
+}
+
+void TaskSnapshotWriter::add(const Task &task)
+{
+    SnapshotRecord record;
+    record.id = task.id;
+    record.dueDay = task.dueDay;
+    record.title = addString(task.title);
+    record.description = addString(task.description);
+    record.subTasks = addString(joinSubTasks(task.subTasks));
+    record.priority = quint8(task.priority);
+    record.status = quint8(task.status);
+    record.reserved = 0;
+    m_records.append(reinterpret_cast<const char *>(&record), sizeof(record));
+    ++m_count;
+}
+
+bool TaskSnapshotWriter::write(const QString &path, qint64 revision, QString *error) const
+{
+    SnapshotHeader header;
+    header.magic = kMagic;
+    header.version = TaskSnapshot::kVersion;
+    header.revision = revision;
+    header.taskCount = m_count;
+    header.poolSize = quint32(m_pool.size());
+    header.reserved = 0;
+    header.checksum = fnv1a(reinterpret_cast<const uchar *>(m_pool.constData()), m_pool.size(),
+                            fnv1a(reinterpret_cast<const uchar *>(m_records.constData()), m_records.size()));
+
+    QSaveFile file(path);
+    bool ok = file.open(QIODevice::WriteOnly)
+        && file.write(reinterpret_cast<const char *>(&header), sizeof(header)) == qint64(sizeof(header))
+        && file.write(m_records) == m_records.size()
+        && file.write(m_pool) == m_pool.size()
+        && file.commit();
+    if (!ok && error)
+        *error = file.errorString();
+    return ok;
+}
@@ -0,0 +1,58 @@
+#ifndef TASKSNAPSHOT_H
+#define TASKSNAPSHOT_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+#include "task.h"
+
+// A binary copy of the tasks table used to paint the board before SQLite
+// has been opened. The file is a fixed header, one fixed-width record per
+// task and a pool of length-prefixed UTF-8 strings that the records point
+// into. The header carries the database revision the copy was taken at
+// and a checksum of everything after it; any mismatch means the file is
+// ignored and the board waits for the real load.
+class TaskSnapshot {
+public:
+    static const quint32 kVersion = 2;
+
+    TaskSnapshot();
+
+    // Maps the file and decodes it; false if it is missing, truncated,
+    // from another format version or fails its checksum.
+    bool load(const QString &path);
+
+    const QVector<Task> &tasks() const { return m_tasks; }
+    qint64 revision() const { return m_revision; }
+    QString errorString() const { return m_error; }
+
+    // Reads only the header; -1 if there is no usable snapshot.
+    static qint64 readRevision(const QString &path);
+
+private:
+    QVector<Task> m_tasks;
+    qint64 m_revision;
+    QString m_error;
+
+    bool fail(const QString &message);
+};
+
+class TaskSnapshotWriter {
+public:
+    TaskSnapshotWriter();
+
+    void add(const Task &task);
+    bool write(const QString &path, qint64 revision, QString *error = nullptr) const;
+
+private:
+    QByteArray m_records;
+    QByteArray m_pool;
+    QHash<QString, quint32> m_interned;
+    quint32 m_count;
+
+    quint32 addString(const QString &text);
+};
+
+#endif // TASKSNAPSHOT_H
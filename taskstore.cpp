@@ -0,0 +1,268 @@
+#include "taskstore.h"
+#include "databaseworker.h"
+
+TaskStore::TaskStore(DatabaseWorker *worker, QObject *parent)
+    : QObject(parent), m_worker(worker)
+{
+    if (m_worker) {
+        connect(m_worker, &DatabaseWorker::tasksLoaded, this, &TaskStore::reset);
+        connect(m_worker, &DatabaseWorker::taskInserted, this, &TaskStore::onTaskInserted);
+        connect(m_worker, &DatabaseWorker::dependenciesLoaded, this, &TaskStore::resetDependencies);
+    }
+}
+
+const Task *TaskStore::taskById(int id) const
+{
+    int idx = indexOf(id);
+    return idx != -1 ? &m_tasks[idx] : nullptr;
+}
+
+void TaskStore::load()
+{
+    if (m_worker) {
+        m_worker->requestLoad();
+        m_worker->requestLoadDependencies();
+    }
+}
+
+void TaskStore::loadDependencies()
+{
+    if (m_worker)
+        m_worker->requestLoadDependencies();
+}
+
+void TaskStore::resetDependencies(const QVector<TaskDependency> &edges)
+{
+    m_dependencies.reset(edges);
+    emit dependenciesChanged();
+}
+
+void TaskStore::reset(const QVector<Task> &tasks)
+{
+    m_tasks = tasks;
+    m_indexById.clear();
+    m_indexById.reserve(m_tasks.size());
+    m_columns.ids.resize(m_tasks.size());
+    m_columns.dueDays.resize(m_tasks.size());
+    m_columns.priorities.resize(m_tasks.size());
+    m_columns.statuses.resize(m_tasks.size());
+    for (int i = 0; i < m_tasks.size(); ++i) {
+        m_indexById.insert(m_tasks[i].id, i);
+        writeColumns(i);
+    }
+    emit tasksReset();
+}
+
+void TaskStore::writeColumns(int idx)
+{
+    const Task &t = m_tasks[idx];
+    m_columns.ids[idx] = t.id;
+    m_columns.dueDays[idx] = t.dueDay;
+    m_columns.priorities[idx] = qint8(t.priority);
+    m_columns.statuses[idx] = t.status;
+}
+
+void TaskStore::appendTask(const Task &task)
+{
+    m_indexById.insert(task.id, m_tasks.size());
+    m_tasks.push_back(task);
+    m_columns.ids.push_back(task.id);
+    m_columns.dueDays.push_back(task.dueDay);
+    m_columns.priorities.push_back(qint8(task.priority));
+    m_columns.statuses.push_back(task.status);
+}
+
+void TaskStore::eraseAt(int idx)
+{
+    // Swap the last slot into the hole so deletes stay O(1); only the
+    // moved task's slot in the index has to change.
+    int last = m_tasks.size() - 1;
+    m_indexById.remove(m_tasks[idx].id);
+    if (idx != last) {
+        m_tasks[idx] = m_tasks[last];
+        m_indexById.insert(m_tasks[idx].id, idx);
+        writeColumns(idx);
+    }
+    m_tasks.removeLast();
+    m_columns.ids.removeLast();
+    m_columns.dueDays.removeLast();
+    m_columns.priorities.removeLast();
+    m_columns.statuses.removeLast();
+}
+
+void TaskStore::addTask(const Task &task)
+{
+    if (m_worker)
+        m_worker->requestInsert(task);
+}
+
+void TaskStore::onTaskInserted(const Task &task)
+{
+    if (indexOf(task.id) != -1)
+        return;
+    appendTask(task);
+    emit taskAdded(task);
+}
+
+bool TaskStore::restoreTask(const Task &task, const QVector<TaskDependency> &edges)
+{
+    if (indexOf(task.id) != -1)
+        return false;
+
+    appendTask(task);
+    const QVector<TaskDependency> restored = restoreEdges(edges);
+    if (m_worker)
+        m_worker->requestRestore(task, restored);
+    emit taskAdded(task);
+    if (!restored.isEmpty())
+        emit dependenciesChanged();
+    return true;
+}
+
+QVector<TaskDependency> TaskStore::restoreEdges(const QVector<TaskDependency> &edges)
+{
+    QVector<TaskDependency> restored;
+    for (const TaskDependency &edge : edges) {
+        if (indexOf(edge.taskId) == -1 || indexOf(edge.dependsOn) == -1
+            || m_dependencies.hasDependency(edge.taskId, edge.dependsOn))
+            continue;
+        if (m_dependencies.addDependency(edge.taskId, edge.dependsOn))
+            restored.push_back(edge);
+    }
+    return restored;
+}
+
+bool TaskStore::updateTask(const Task &task)
+{
+    int idx = indexOf(task.id);
+    if (idx == -1)
+        return false;
+
+    m_tasks[idx] = task;
+    writeColumns(idx);
+    if (m_worker)
+        m_worker->requestUpdate(task);
+    emit taskUpdated(task);
+    return true;
+}
+
+bool TaskStore::setStatus(int id, TaskStatus status)
+{
+    int idx = indexOf(id);
+    if (idx == -1)
+        return false;
+
+    m_tasks[idx].status = status;
+    m_columns.statuses[idx] = status;
+    if (m_worker)
+        m_worker->requestStatus(id, status);
+    emit taskUpdated(m_tasks[idx]);
+    return true;
+}
+
+bool TaskStore::removeTask(int id)
+{
+    int idx = indexOf(id);
+    if (idx == -1)
+        return false;
+
+    eraseAt(idx);
+    // The database drops the task's edges with it.
+    const bool hadEdges = m_dependencies.hasEdges(id);
+    m_dependencies.removeTask(id);
+    if (m_worker)
+        m_worker->requestRemove(id);
+    emit taskRemoved(id);
+    if (hadEdges)
+        emit dependenciesChanged();
+    return true;
+}
+
+int TaskStore::setStatuses(const QVector<int> &ids, TaskStatus status)
+{
+    QVector<Task> changed;
+    QVector<int> changedIds;
+    for (int id : ids) {
+        int idx = indexOf(id);
+        if (idx == -1 || m_tasks[idx].status == status)
+            continue;
+        m_tasks[idx].status = status;
+        m_columns.statuses[idx] = status;
+        changed.push_back(m_tasks[idx]);
+        changedIds.push_back(id);
+    }
+    if (changed.isEmpty())
+        return 0;
+    if (m_worker)
+        m_worker->requestStatuses(changedIds, status);
+    emit tasksChanged(changed, QVector<int>());
+    return changed.size();
+}
+
+int TaskStore::removeTasks(const QVector<int> &ids)
+{
+    QVector<int> removed;
+    bool hadEdges = false;
+    for (int id : ids) {
+        int idx = indexOf(id);
+        if (idx == -1)
+            continue;
+        eraseAt(idx);
+        hadEdges = m_dependencies.hasEdges(id) || hadEdges;
+        m_dependencies.removeTask(id);
+        removed.push_back(id);
+    }
+    if (removed.isEmpty())
+        return 0;
+    if (m_worker)
+        m_worker->requestRemoveTasks(removed);
+    emit tasksChanged(QVector<Task>(), removed);
+    if (hadEdges)
+        emit dependenciesChanged();
+    return removed.size();
+}
+
+int TaskStore::restoreTasks(const QVector<Task> &tasks, const QVector<TaskDependency> &edges)
+{
+    QVector<Task> restored;
+    for (const Task &task : tasks) {
+        if (indexOf(task.id) != -1)
+            continue;
+        appendTask(task);
+        restored.push_back(task);
+    }
+    if (restored.isEmpty())
+        return 0;
+    // Only once every task is back, so edges between them are kept too.
+    const QVector<TaskDependency> restoredEdges = restoreEdges(edges);
+    if (m_worker)
+        m_worker->requestRestoreTasks(restored, restoredEdges);
+    emit tasksChanged(restored, QVector<int>());
+    if (!restoredEdges.isEmpty())
+        emit dependenciesChanged();
+    return restored.size();
+}
+
+bool TaskStore::addDependency(int taskId, int dependsOn)
+{
+    if (indexOf(taskId) == -1 || indexOf(dependsOn) == -1)
+        return false;
+    if (m_dependencies.hasDependency(taskId, dependsOn))
+        return true;
+    if (!m_dependencies.addDependency(taskId, dependsOn))
+        return false;
+    if (m_worker)
+        m_worker->requestAddDependency(taskId, dependsOn);
+    emit dependenciesChanged();
+    return true;
+}
+
+bool TaskStore::removeDependency(int taskId, int dependsOn)
+{
+    if (!m_dependencies.removeDependency(taskId, dependsOn))
+        return false;
+    if (m_worker)
+        m_worker->requestRemoveDependency(taskId, dependsOn);
+    emit dependenciesChanged();
+    return true;
+}
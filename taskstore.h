@@ -0,0 +1,85 @@
+#ifndef TASKSTORE_H
+#define TASKSTORE_H
+
+#include <QObject>
+#include <QHash>
+#include <QVector>
+
+#include "task.h"
+#include "taskdag.h"
+#include "taskrepository.h"
+
+class DatabaseWorker;
+
+// The fields scans, sorts and filters read, one array per field and
+// index-aligned with TaskStore::tasks().
+struct TaskColumns {
+    QVector<int> ids;
+    QVector<qint32> dueDays;
+    QVector<qint8> priorities;
+    QVector<TaskStatus> statuses;
+};
+
+class TaskStore : public QObject {
+    Q_OBJECT
+
+public:
+    explicit TaskStore(DatabaseWorker *worker = nullptr, QObject *parent = nullptr);
+
+    const QVector<Task> &tasks() const { return m_tasks; }
+    const TaskColumns &columns() const { return m_columns; }
+    const Task *taskById(int id) const;
+    int indexOf(int id) const { return m_indexById.value(id, -1); }
+
+    void load();
+    void reset(const QVector<Task> &tasks);
+
+    const TaskDag &dependencies() const { return m_dependencies; }
+    void loadDependencies();
+    void resetDependencies(const QVector<TaskDependency> &edges);
+
+    // Mutations patch the in-memory copy at once and queue the matching
+    // write on the database worker. New tasks appear once the worker has
+    // assigned their id.
+    void addTask(const Task &task);
+    // Edges whose other task is gone, or that would now close a cycle,
+    // are left out.
+    bool restoreTask(const Task &task, const QVector<TaskDependency> &edges = QVector<TaskDependency>());
+    bool updateTask(const Task &task);
+    bool setStatus(int id, TaskStatus status);
+    bool removeTask(int id);
+    // Bulk edits: one worker transaction and a single tasksChanged for the
+    // lot. Unknown ids are skipped; each returns how many tasks changed.
+    int setStatuses(const QVector<int> &ids, TaskStatus status);
+    int removeTasks(const QVector<int> &ids);
+    int restoreTasks(const QVector<Task> &tasks, const QVector<TaskDependency> &edges = QVector<TaskDependency>());
+    // False if either task is unknown or the edge would close a cycle.
+    bool addDependency(int taskId, int dependsOn);
+    bool removeDependency(int taskId, int dependsOn);
+
+signals:
+    void tasksReset();
+    void taskAdded(const Task &task);
+    void taskUpdated(const Task &task);
+    void taskRemoved(int id);
+    // A bulk edit: tasks added or updated, and ids removed.
+    void tasksChanged(const QVector<Task> &changed, const QVector<int> &removed);
+    void dependenciesChanged();
+
+private slots:
+    void onTaskInserted(const Task &task);
+
+private:
+    DatabaseWorker *m_worker;
+    QVector<Task> m_tasks;
+    TaskColumns m_columns;
+    QHash<int, int> m_indexById;
+    TaskDag m_dependencies;
+
+    void appendTask(const Task &task);
+    void eraseAt(int idx);
+    void writeColumns(int idx);
+    QVector<TaskDependency> restoreEdges(const QVector<TaskDependency> &edges);
+};
+
+#endif // TASKSTORE_H
@@ -0,0 +1,356 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDate>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "taskexporter.h"
+#include "taskrepository.h"
+
+// Reads one JSON command per line from stdin and writes one JSON object
+// per line to stdout. The whole batch runs in a single transaction.
+//
+//   {"op":"add", "title":..., "description":..., "dueDate":"yyyy-MM-dd", "priority":0-5, "subtasks":...}
+//   {"op":"update", "id":N, any of the add fields or "status"}
+//   {"op":"status", "id":N, "status":"pending"|"in progress"|"complete"}
+//   {"op":"delete", "id":N}
+//   {"op":"get", "id":N}
+//   {"op":"list", "status":..., "sort":"id"|"due"|"priority", "limit":N}
+//   {"op":"search", "text":..., "limit":N}
+//   {"op":"due", "date":"yyyy-MM-dd"}
+//   {"op":"export", "path":...}
+//
+// Every command gets a result line {"line":N,"op":...,"ok":true|false,...};
+// list, search and due print one line per task before it.
+
+namespace {
+
+class CommandRunner {
+public:
+    CommandRunner(TaskRepository &repo, QFile &out) : m_repo(repo), m_out(out), m_failed(0) {}
+
+    void run(int line, const QByteArray &text);
+    bool flush();
+    int failedCount() const { return m_failed; }
+
+private:
+    TaskRepository &m_repo;
+    QFile &m_out;
+    QByteArray m_buffer;
+    int m_failed;
+
+    bool add(const QJsonObject &cmd, QByteArray &result);
+    bool update(const QJsonObject &cmd, QByteArray &result);
+    bool setStatus(const QJsonObject &cmd, QByteArray &result);
+    bool remove(const QJsonObject &cmd, QByteArray &result);
+    bool get(const QJsonObject &cmd, QByteArray &result);
+    bool list(const QJsonObject &cmd, QByteArray &result);
+    bool search(const QJsonObject &cmd, QByteArray &result);
+    bool due(const QJsonObject &cmd, QByteArray &result);
+    bool exportTasks(const QJsonObject &cmd, QByteArray &result);
+
+    bool applyFields(const QJsonObject &cmd, Task &task, QByteArray &result);
+    bool fetch(const QJsonObject &cmd, Task &task, QByteArray &result);
+    void writeTask(const Task &task);
+    static bool error(QByteArray &result, const QString &message);
+};
+
+bool CommandRunner::error(QByteArray &result, const QString &message)
+{
+    result += ",\"error\":";
+    appendJsonString(result, message);
+    return false;
+}
+
+void CommandRunner::run(int line, const QByteArray &text)
+{
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(text, &parseError);
+    const QJsonObject cmd = doc.object();
+    const QString op = cmd.value("op").toString();
+
+    QByteArray result;
+    bool ok = false;
+    if (!doc.isObject())
+        ok = error(result, "Not a JSON object: " + parseError.errorString());
+    else if (op == "add")
+        ok = add(cmd, result);
+    else if (op == "update")
+        ok = update(cmd, result);
+    else if (op == "status")
+        ok = setStatus(cmd, result);
+    else if (op == "delete")
+        ok = remove(cmd, result);
+    else if (op == "get")
+        ok = get(cmd, result);
+    else if (op == "list")
+        ok = list(cmd, result);
+    else if (op == "search")
+        ok = search(cmd, result);
+    else if (op == "due")
+        ok = due(cmd, result);
+    else if (op == "export")
+        ok = exportTasks(cmd, result);
+    else
+        ok = error(result, "Unknown op.");
+
+    if (!ok)
+        ++m_failed;
+    m_buffer += "{\"line\":";
+    m_buffer += QByteArray::number(line);
+    m_buffer += ",\"op\":";
+    appendJsonString(m_buffer, op);
+    m_buffer += ok ? ",\"ok\":true" : ",\"ok\":false";
+    m_buffer += result;
+    m_buffer += "}\n";
+    if (m_buffer.size() >= 1 << 16)
+        flush();
+}
+
+bool CommandRunner::flush()
+{
+    bool ok = m_out.write(m_buffer) == m_buffer.size();
+    m_buffer.resize(0);
+    return m_out.flush() && ok;
+}
+
+void CommandRunner::writeTask(const Task &task)
+{
+    appendTaskJson(m_buffer, task);
+    m_buffer += '\n';
+    if (m_buffer.size() >= 1 << 16)
+        flush();
+}
+
+bool CommandRunner::applyFields(const QJsonObject &cmd, Task &task, QByteArray &result)
+{
+    if (cmd.contains("title"))
+        task.title = cmd.value("title").toString();
+    if (cmd.contains("description"))
+        task.description = cmd.value("description").toString();
+    if (cmd.contains("subtasks"))
+        task.subTasks = splitSubTasks(cmd.value("subtasks").toString());
+    if (cmd.contains("priority"))
+        task.priority = cmd.value("priority").toInt(-1);
+
+    if (task.title.trimmed().isEmpty())
+        return error(result, "title is required.");
+    if (cmd.contains("dueDate") && !parseDueDay(cmd.value("dueDate").toString(), &task.dueDay))
+        return error(result, "dueDate must be a valid date in yyyy-MM-dd format.");
+    if (task.priority < 0 || task.priority > 5)
+        return error(result, "priority must be between 0 and 5.");
+    if (cmd.contains("status") && !parseTaskStatus(cmd.value("status").toString(), &task.status))
+        return error(result, "status must be pending, in progress or complete.");
+    return true;
+}
+
+bool CommandRunner::fetch(const QJsonObject &cmd, Task &task, QByteArray &result)
+{
+    const int id = cmd.value("id").toInt(-1);
+    if (id < 0)
+        return error(result, "id is required.");
+    if (!m_repo.loadTask(id, &task))
+        return error(result, QString("No task with id %1.").arg(id));
+    return true;
+}
+
+bool CommandRunner::add(const QJsonObject &cmd, QByteArray &result)
+{
+    Task task;
+    task.id = 0;
+    task.dueDay = kNoDueDay;
+    task.priority = 0;
+    task.status = TaskStatus::Pending;
+    if (!applyFields(cmd, task, result))
+        return false;
+    const int id = m_repo.insertImportedTask(task);
+    if (id == -1)
+        return error(result, m_repo.lastError());
+    result += ",\"id\":";
+    result += QByteArray::number(id);
+    return true;
+}
+
+bool CommandRunner::update(const QJsonObject &cmd, QByteArray &result)
+{
+    Task task;
+    if (!fetch(cmd, task, result) || !applyFields(cmd, task, result))
+        return false;
+    if (!m_repo.updateTask(task))
+        return error(result, m_repo.lastError());
+    return true;
+}
+
+bool CommandRunner::setStatus(const QJsonObject &cmd, QByteArray &result)
+{
+    Task task;
+    TaskStatus status = TaskStatus::Pending;
+    if (!fetch(cmd, task, result))
+        return false;
+    if (!parseTaskStatus(cmd.value("status").toString(), &status))
+        return error(result, "status must be pending, in progress or complete.");
+    if (!m_repo.updateStatus(task.id, status))
+        return error(result, m_repo.lastError());
+    return true;
+}
+
+bool CommandRunner::remove(const QJsonObject &cmd, QByteArray &result)
+{
+    Task task;
+    if (!fetch(cmd, task, result))
+        return false;
+    if (!m_repo.removeTask(task.id))
+        return error(result, m_repo.lastError());
+    return true;
+}
+
+bool CommandRunner::get(const QJsonObject &cmd, QByteArray &result)
+{
+    Task task;
+    if (!fetch(cmd, task, result))
+        return false;
+    result += ",\"task\":";
+    appendTaskJson(result, task);
+    return true;
+}
+
+bool CommandRunner::list(const QJsonObject &cmd, QByteArray &result)
+{
+    const QString sort = cmd.value("sort").toString("id");
+    TaskOrder order = TaskOrder::ById;
+    if (sort == "due")
+        order = TaskOrder::ByDueDate;
+    else if (sort == "priority")
+        order = TaskOrder::ByPriority;
+    else if (sort != "id")
+        return error(result, "sort must be id, due or priority.");
+
+    TaskStatus status = TaskStatus::Pending;
+    const bool byStatus = !cmd.value("status").toString().isEmpty();
+    if (byStatus && !parseTaskStatus(cmd.value("status").toString(), &status))
+        return error(result, "status must be pending, in progress or complete.");
+    const int limit = cmd.value("limit").toInt(-1);
+    int count = 0;
+    bool ok = m_repo.forEachTask([&](const Task &task) {
+        if (byStatus && task.status != status)
+            return true;
+        writeTask(task);
+        return ++count != limit;
+    }, order);
+    if (!ok)
+        return error(result, m_repo.lastError());
+    result += ",\"count\":";
+    result += QByteArray::number(count);
+    return true;
+}
+
+bool CommandRunner::search(const QJsonObject &cmd, QByteArray &result)
+{
+    const QString text = cmd.value("text").toString();
+    if (text.trimmed().isEmpty())
+        return error(result, "text is required.");
+    int count = 0;
+    bool ok = m_repo.search(text, cmd.value("limit").toInt(100), [&](const SearchHit &hit) {
+        Task task;
+        if (m_repo.loadTask(hit.id, &task)) {
+            writeTask(task);
+            ++count;
+        }
+        return true;
+    });
+    if (!ok)
+        return error(result, m_repo.lastError());
+    result += ",\"count\":";
+    result += QByteArray::number(count);
+    return true;
+}
+
+bool CommandRunner::due(const QJsonObject &cmd, QByteArray &result)
+{
+    QDate date = QDate::currentDate().addDays(1);
+    if (cmd.contains("date"))
+        date = QDate::fromString(cmd.value("date").toString(), "yyyy-MM-dd");
+    if (!date.isValid())
+        return error(result, "date must be a valid date in yyyy-MM-dd format.");
+    QVector<Task> tasks;
+    if (!m_repo.loadOpenTasksDueBy(date, &tasks))
+        return error(result, m_repo.lastError());
+    for (const Task &task : tasks)
+        writeTask(task);
+    result += ",\"count\":";
+    result += QByteArray::number(tasks.size());
+    return true;
+}
+
+bool CommandRunner::exportTasks(const QJsonObject &cmd, QByteArray &result)
+{
+    const QString path = cmd.value("path").toString();
+    if (path.isEmpty())
+        return error(result, "path is required.");
+    TaskExporter exporter(m_repo);
+    if (!exporter.exportFile(path))
+        return error(result, exporter.errorString());
+    result += ",\"count\":";
+    result += QByteArray::number(exporter.exportedCount());
+    return true;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("todo-cli");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Runs JSON task commands from stdin, one per line, "
+                                     "and writes one JSON result per line to stdout.");
+    parser.addHelpOption();
+    QCommandLineOption dbOption({"d", "db"}, "Database file.", "path", "./todo.db");
+    QCommandLineOption atomicOption("atomic", "Roll back the whole batch if any command fails.");
+    parser.addOption(dbOption);
+    parser.addOption(atomicOption);
+    parser.process(app);
+
+    QFile out;
+    out.open(stdout, QIODevice::WriteOnly);
+    QFile in;
+    in.open(stdin, QIODevice::ReadOnly);
+
+    TaskRepository repo("todo-cli");
+    if (!repo.open(parser.value(dbOption)) || !repo.beginTransaction()) {
+        QByteArray line = "{\"ok\":false,\"error\":";
+        appendJsonString(line, repo.lastError());
+        out.write(line + "}\n");
+        return 2;
+    }
+
+    CommandRunner runner(repo, out);
+    int lineNumber = 0;
+    while (!in.atEnd()) {
+        const QByteArray line = in.readLine().trimmed();
+        ++lineNumber;
+        if (line.isEmpty() || line.startsWith('#'))
+            continue;
+        runner.run(lineNumber, line);
+    }
+
+    bool ok = runner.failedCount() == 0;
+    QByteArray summary;
+    if (!ok && parser.isSet(atomicOption)) {
+        repo.rollbackTransaction();
+        summary = "{\"op\":\"rollback\",\"ok\":true}\n";
+    } else if (repo.commitTransaction()) {
+        summary = "{\"op\":\"commit\",\"ok\":true}\n";
+    } else {
+        ok = false;
+        summary = "{\"op\":\"commit\",\"ok\":false,\"error\":";
+        appendJsonString(summary, repo.lastError());
+        summary += "}\n";
+    }
+    runner.flush();
+    out.write(summary);
+    out.flush();
+    return ok ? 0 : 1;
+}